@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+
+
+/**
+ * Memory of the analysis containers (FreeVariables, LiveVariables, CFG, ProgramPoints, ...).
+ * They are std::pmr containers, dfa_utils, set_utils and the LV transfer functions allocate them from the current
+ * resource of the calling thread. Outside of any Scope that is the default resource, so callers that do not care
+ * get ordinary heap containers.
+ */
+namespace analysis_memory {
+    /**
+     * The current resource of the calling thread.
+     */
+    std::pmr::memory_resource* resource();
+
+    /**
+     * Makes a resource current for the calling thread until the scope ends, scopes nest.
+     * Containers allocated from the resource have to be gone before it is released.
+     */
+    class Scope {
+    public:
+        explicit Scope(std::pmr::memory_resource* resource);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        auto operator=(const Scope&) -> Scope& = delete;
+
+    private:
+        std::pmr::memory_resource* previous_;
+    };
+
+    /**
+     * Memory that lives as long as an analysis: a monotonic buffer, freed as a whole at the end, with a pool in
+     * front that reuses the nodes of temporaries. Checking well-formedness alone builds quadratically many
+     * program point sets, without the pool they would all stay in the buffer. Not thread safe.
+     */
+    class Arena {
+    public:
+        Arena(): pool_{&buffer_} {}
+
+        Arena(const Arena&) = delete;
+        auto operator=(const Arena&) -> Arena& = delete;
+
+        [[nodiscard]] std::pmr::memory_resource* resource() { return &pool_; }
+
+    private:
+        std::pmr::monotonic_buffer_resource buffer_;
+        std::pmr::unsynchronized_pool_resource pool_;
+    };
+
+    /**
+     * Forwards to upstream and counts the allocations, e.g. as the default resource of a benchmark.
+     */
+    class CountingResource: public std::pmr::memory_resource {
+    public:
+        explicit CountingResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()):
+            upstream_{upstream} {}
+
+        [[nodiscard]] std::size_t allocations() const { return allocations_; }
+        [[nodiscard]] std::size_t bytes() const { return bytes_; }
+
+    private:
+        std::pmr::memory_resource* upstream_;
+        std::atomic<std::size_t> allocations_{0};
+        std::atomic<std::size_t> bytes_{0};
+
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+        [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+    };
+
+    /**
+     * Peak resident set size of the process in KiB, 0 where the platform does not report it.
+     */
+    std::size_t peak_rss_kb();
+}
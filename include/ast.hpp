@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <variant>
 #include <memory>
 
@@ -48,18 +49,22 @@ using BExp = std::variant<
 // Program points
 using PP = unsigned int;
 
+// Kind of an elementary block, dispatching on it needs no RTTI
+enum class BlockKind: std::uint8_t { Skip, Assign, Cond };
+
 // This is a base struct for all possible elementary blocks:
 // Skip, Assign and Cond (if or while condition)
 struct Block {
     PP pp_; 
+    BlockKind kind_;                    // Set by the derived block, static_cast to it after checking
 
-    Block(PP pp): pp_{pp} {}
+    Block(PP pp, BlockKind kind): pp_{pp}, kind_{kind} {}
 
     virtual ~Block() = default;
 };
 
 struct Skip: public Block {
-    Skip(PP pp): Block{pp} {}
+    Skip(PP pp): Block{pp, BlockKind::Skip} {}
 };
 
 struct Assign: public Block {
@@ -67,14 +72,14 @@ struct Assign: public Block {
     std::unique_ptr<AExp> aexp_;
 
     Assign(PP pp, std::unique_ptr<Var> var, std::unique_ptr<AExp> aexp): 
-        Block{pp}, var_{std::move(var)}, aexp_{std::move(aexp)} {}
+        Block{pp, BlockKind::Assign}, var_{std::move(var)}, aexp_{std::move(aexp)} {}
 };
 
 struct Cond: public Block {
     std::unique_ptr<BExp> bexp_;
 
     Cond(PP pp, std::unique_ptr<BExp> bexp): 
-        Block{pp}, bexp_{std::move(bexp)} {}
+        Block{pp, BlockKind::Cond}, bexp_{std::move(bexp)} {}
 };
 
 struct If {
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "ast.hpp"
+
+
+/**
+ * Compact binary format of the AST, so programs that are analyzed again and again skip lexer and parser.
+ *
+ *  header      "SDPAAST" and a version byte
+ *  names       varint count, then every variable name as varint length and bytes
+ *  statement   the program in prefix order, every node is a tag byte followed by its fields
+ *
+ * Numbers, name indices and operators (an index into a fixed table of their spellings) are LEB128 varints.
+ * Program points are stored as the zigzag varint difference to the previous one, consecutive numbering takes
+ * one byte per program point. A sequence is stored as the number of statements along its right spine followed
+ * by the statements, reading it builds the same nesting as the parser, so the tree is restored exactly.
+ */
+namespace ast_binary {
+    constexpr std::uint8_t version = 1;
+
+    std::string write(const Stmt* stmt);
+    void write_file(const Stmt* stmt, const std::filesystem::path& path);
+
+    /**
+     * Throws if data is not a program of this version or is malformed, which includes nesting deeper than
+     * the reader supports (4096 nodes from the root, sequences count once).
+     */
+    std::unique_ptr<Stmt> read(std::string_view data);
+
+    /**
+     * Maps the file and reads the program from the mapping.
+     */
+    std::unique_ptr<Stmt> read_file(const std::filesystem::path& path);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+
+#include "ast.hpp"
+
+
+/**
+ * Structural (Merkle) hashes of AST nodes. The hash of a node combines its kind, its own data (names, numbers,
+ * operators) and the hashes of its children, program points are left out. Two subtrees that only differ in
+ * their numbering hash the same, e.g. the same loop body at two places of a program or in two programs.
+ */
+namespace ast_hash {
+    using Hash = std::uint64_t;
+    using StmtHashes = std::unordered_map<const Stmt*, Hash>;
+
+    Hash hash_aexp(const AExp* aexp);
+    Hash hash_bexp(const BExp* bexp);
+    Hash hash_stmt(const Stmt* stmt);
+
+    /**
+     * Hashes of every statement within stmt in one bottom-up pass, every node is hashed once.
+     */
+    StmtHashes hash_statements(const Stmt* stmt);
+}
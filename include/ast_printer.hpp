@@ -1,6 +1,7 @@
 #pragma once
 
 #include <iostream>
+#include <ostream>
 
 #include "ast.hpp"
 
@@ -279,3 +280,125 @@ private:
         return std::string(depth, '\t');
     }
 };
+
+
+
+/**
+ * Prints statements in the concrete WL syntax, so that the output can be read back by the Lexer and Parser.
+ */
+struct ASTSourcePrinter {
+    std::ostream& out_;
+
+    explicit ASTSourcePrinter(std::ostream& out = std::cout): out_{out} {}
+
+    void operator()(const Skip& stmt, const unsigned int depth) const {
+        out_ << get_indent_based_on_depth(depth);
+        out_ << "[skip]^" << stmt.pp_;
+    }
+
+    void operator()(const Assign& stmt, const unsigned int depth) const {
+        out_ << get_indent_based_on_depth(depth);
+        out_ << "[" << stmt.var_->name_ << " := ";
+        print(*stmt.aexp_);
+        out_ << "]^" << stmt.pp_;
+    }
+
+    void operator()(const If& stmt, const unsigned int depth) const {
+        out_ << get_indent_based_on_depth(depth);
+        out_ << "if [";
+        print(*stmt.cond_->bexp_);
+        out_ << "]^" << stmt.cond_->pp_ << "\n";
+        out_ << get_indent_based_on_depth(depth + 1) << "then\n";
+        print(*stmt.then_, depth + 2);
+        out_ << "\n";
+        out_ << get_indent_based_on_depth(depth + 1) << "else\n";
+        print(*stmt.else_, depth + 2);
+        out_ << "\n";
+        out_ << get_indent_based_on_depth(depth) << "fi";
+    }
+
+    void operator()(const While& stmt, const unsigned int depth) const {
+        out_ << get_indent_based_on_depth(depth);
+        out_ << "while [";
+        print(*stmt.cond_->bexp_);
+        out_ << "]^" << stmt.cond_->pp_ << " do\n";
+        print(*stmt.body_, depth + 1);
+        out_ << "\n";
+        out_ << get_indent_based_on_depth(depth) << "od";
+    }
+
+    void operator()(const SeqComp& stmt, const unsigned int depth) const {
+        print(*stmt.fst_, depth);
+        out_ << ";\n";
+        print(*stmt.snd_, depth);
+    }
+
+    void operator()(const Var& var) const {
+        out_ << var.name_;
+    }
+
+    void operator()(const Num& num) const {
+        out_ << num.val_;
+    }
+
+    void operator()(const ArithmeticOp& op) const {
+        out_ << "(";
+        print(*op.lhs_);
+        out_ << " " << op.op_ << " ";
+        print(*op.rhs_);
+        out_ << ")";
+    }
+
+    void operator()(const True&) const {
+        out_ << "true";
+    }
+
+    void operator()(const False&) const {
+        out_ << "false";
+    }
+
+    void operator()(const Not& not_op) const {
+        out_ << "(not ";
+        print(*not_op.b_);
+        out_ << ")";
+    }
+
+    void operator()(const BooleanOp& op) const {
+        out_ << "(";
+        print(*op.lhs_);
+        out_ << " " << op.op_ << " ";
+        print(*op.rhs_);
+        out_ << ")";
+    }
+
+    void operator()(const RelationalOp& op) const {
+        out_ << "(";
+        print(*op.lhs_);
+        out_ << " " << op.op_ << " ";
+        print(*op.rhs_);
+        out_ << ")";
+    }
+
+    void print(const Stmt& stmt, const unsigned int depth = 0) const {
+        std::visit([this, depth](const auto& _node) {
+            this->operator()(_node, depth);
+        }, stmt);
+    }
+
+    void print(const AExp& aexp) const {
+        std::visit([this](const auto& _node) {
+            this->operator()(_node);
+        }, aexp);
+    }
+
+    void print(const BExp& bexp) const {
+        std::visit([this](const auto& _node) {
+            this->operator()(_node);
+        }, bexp);
+    }
+
+private:
+    [[nodiscard]] std::string get_indent_based_on_depth(const unsigned int depth) const {
+        return std::string(4 * depth, ' ');
+    }
+};
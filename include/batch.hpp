@@ -0,0 +1,60 @@
+#pragma once
+
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "lv.hpp"
+
+class SummaryCache;
+
+
+/**
+ * Result of analyzing one program in batch mode.
+ * Failures (lexer, syntax and well-formedness errors) are recorded instead of aborting the batch.
+ */
+struct BatchResult {
+    std::filesystem::path path_;
+    bool ok_;
+    std::string error_;
+    unsigned int iterations_;
+    std::string output_;                // Printed LV result
+};
+
+
+/**
+ * Batch analysis of many .wlang files on a work-stealing thread pool.
+ * Every file runs through lex -> parse -> checks -> LV independently.
+ */
+namespace batch {
+    /**
+     * Collects the programs to analyze. A directory is searched recursively for .wlang files,
+     * a .wlang file is taken as is, and any other file is read as a list with one path per line.
+     */
+    std::vector<std::filesystem::path> collect_inputs(const std::filesystem::path& input);
+
+    // Programs loaded per round of the bulk loader
+    constexpr std::size_t load_chunk_size = 4096;
+
+    /**
+     * With a summary cache, the program info is composed from cached summaries and the structural solver takes
+     * its gen/kill summaries from there, summaries of new statements are added to the cache.
+     */
+    BatchResult analyze_file(const std::filesystem::path& path, LVSolver solver = LVSolver::RoundRobin,
+                             SummaryCache* summaries = nullptr);
+    BatchResult analyze_program(const std::filesystem::path& path, std::string program_text,
+                                LVSolver solver = LVSolver::RoundRobin, SummaryCache* summaries = nullptr);
+
+    /**
+     * Loads the files in chunks with the BulkLoader, overlapped with the analysis of the previous chunk, and analyzes
+     * them on n_threads workers, results are in the order of the inputs. Every file is solved sequentially, parallel solvers are not allowed.
+     * All workers share the summary cache, if one is given.
+     */
+    std::vector<BatchResult> run(const std::vector<std::filesystem::path>& paths, unsigned int n_threads,
+                                 LVSolver solver = LVSolver::RoundRobin, SummaryCache* summaries = nullptr);
+
+    void write_result(const BatchResult& result, std::ostream& os);
+    void write_summary(std::size_t analyzed, std::size_t failed, std::ostream& os);
+    void write_results(const std::vector<BatchResult>& results, std::ostream& os);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "ast.hpp"
+#include "interpreter.hpp"
+
+
+// Columnar states: columns[slot][i] is the value of the variable in slot `slot` in state i
+using StateColumns = std::vector<std::vector<Value>>;
+
+
+/**
+ * Executes one WL program over many initial states in lockstep.
+ *
+ * States are processed in groups of Lanes (8 or 16), one state per SIMD lane. Conditions are
+ * evaluated for all lanes at once and control flow diverges through per-lane masks: both branches
+ * of an If run under complementary masks, and a While keeps iterating only for the lanes whose
+ * condition still holds, retiring the others. Assignments only write the active lanes.
+ */
+class BatchProgram {
+public:
+    explicit BatchProgram(const Stmt* stmt);
+
+    /*
+     * Runs the program on every state of the columnar input and returns the columnar final states.
+     * The input needs one column per slot (see slots()), all of the same length.
+     */
+    template<unsigned int Lanes>
+    [[nodiscard]] StateColumns run(const StateColumns& initial) const;
+
+    [[nodiscard]] const VarSlots& slots() const { return slots_; }
+
+    enum class NodeKind : std::uint8_t {
+        Skip, Assign, If, While, Seq,
+        Var, Num, Arithmetic,
+        True, False, Not, And, Or, Relational
+    };
+
+    /*
+     * Flattened AST node, children and slots are indices.
+     */
+    struct Node {
+        NodeKind kind_;
+        std::uint8_t op_;           // ArithmeticOpKind or RelationalOpKind
+        unsigned int a_;            // slot of Var and Assign, first child otherwise
+        unsigned int b_;
+        unsigned int c_;
+        Value value_;               // constant of Num
+    };
+
+private:
+    VarSlots slots_;
+    std::vector<Node> nodes_;
+    unsigned int root_;
+
+    unsigned int add(Node node);
+    unsigned int compile_stmt(const Stmt* stmt);
+    unsigned int compile_aexp(const AExp* aexp);
+    unsigned int compile_bexp(const BExp* bexp);
+};
@@ -0,0 +1,674 @@
+#pragma once
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+
+#if __has_include(<sys/wait.h>)
+#define SDPA_FORK 1
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "interpreter.hpp"
+#include "jit.hpp"
+#include "closure_compiler.hpp"
+#include "batch_executor.hpp"
+#include "c_backend.hpp"
+#include "partial_evaluator.hpp"
+#include "lv.hpp"
+#include "thread_pool.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "incremental.hpp"
+#include "incremental_parser.hpp"
+#include "summary_cache.hpp"
+#include "ast_binary.hpp"
+#include "result_store.hpp"
+#include "var_sets.hpp"
+#include "analysis_memory.hpp"
+
+
+template<typename F>
+double measure_ms(F&& f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+/*
+ * Baseline of the execution benchmarks: runs the AST-walking interpreter once per input, where input i sets every
+ * variable to i % 16, and adds up the final states in checksum. Returns the time in ms.
+ */
+double interpreter_baseline(const Stmt* stmt, const VarSlots& slots, unsigned int runs, Value& checksum) {
+    return measure_ms([&]() {
+        for (unsigned int i = 0; i < runs; ++i) {
+            State state{};
+            for (const auto& [name, slot]: slots) state[name] = i % 16;
+            interpreter::exec_stmt(stmt, state);
+            for (const auto& [name, value]: state) checksum += value;
+        }
+    });
+}
+
+void print_speedup(const std::string& name, double baseline_ms, double ms) {
+    std::cout << "\t" << name << ": " << ms << " ms (" << (baseline_ms / ms) << "x)\n";
+}
+
+
+/*
+ * Runs the program once per input, where input i sets every variable to i % 16,
+ * and compares the AST-walking interpreter with the JIT.
+ */
+void benchmark_jit(const Stmt* stmt, unsigned int runs = 100000) {
+    const JitProgram jit{stmt};
+    const auto& slots = jit.slots();
+
+    Value checksum_interpreter = 0;
+    const double interpreter_ms = interpreter_baseline(stmt, slots, runs, checksum_interpreter);
+
+    Value checksum_jit = 0;
+    std::vector<Value> values(slots.size());
+    const double jit_ms = measure_ms([&]() {
+        for (unsigned int i = 0; i < runs; ++i) {
+            std::fill(values.begin(), values.end(), i % 16);
+            jit.run(values.data());
+            for (const auto value: values) checksum_jit += value;
+        }
+    });
+
+    std::cout << "JIT benchmark (" << runs << " runs, "
+              << (jit.is_native() ? "native, " : "interpreter fallback, ")
+              << jit.code_size() << " bytes of code):\n";
+    std::cout << "\tinterpreter: " << interpreter_ms << " ms\n";
+    print_speedup("jit", interpreter_ms, jit_ms);
+    if (checksum_interpreter != checksum_jit) std::cout << "\tresults differ!\n";
+}
+
+
+/*
+ * Same workload as benchmark_jit, comparing the std::visit interpreter with the closure-compiled program.
+ */
+void benchmark_closures(const Stmt* stmt, unsigned int runs = 100000) {
+    const ClosureProgram program{stmt};
+    const auto& slots = program.slots();
+
+    Value checksum_interpreter = 0;
+    const double interpreter_ms = interpreter_baseline(stmt, slots, runs, checksum_interpreter);
+
+    Value checksum_closures = 0;
+    std::vector<Value> values(slots.size());
+    const double closures_ms = measure_ms([&]() {
+        for (unsigned int i = 0; i < runs; ++i) {
+            std::fill(values.begin(), values.end(), i % 16);
+            program.run(values.data());
+            for (const auto value: values) checksum_closures += value;
+        }
+    });
+
+    std::cout << "Closure benchmark (" << runs << " runs):\n";
+    std::cout << "\tinterpreter: " << interpreter_ms << " ms\n";
+    print_speedup("closures", interpreter_ms, closures_ms);
+    if (checksum_interpreter != checksum_closures) std::cout << "\tresults differ!\n";
+}
+
+
+/*
+ * Runs the program over n_states initial states (state i sets every variable to i % 16),
+ * one state at a time and in lockstep lane groups of 8 and 16.
+ */
+void benchmark_batch(const Stmt* stmt, std::size_t n_states = 1 << 20) {
+    const BatchProgram batch{stmt};
+    const ClosureProgram closures{stmt};
+    const auto& slots = batch.slots();
+
+    StateColumns initial(slots.size(), std::vector<Value>(n_states));
+    for (auto& column: initial) {
+        for (std::size_t i = 0; i < n_states; ++i) column[i] = static_cast<Value>(i % 16);
+    }
+
+    StateColumns one_at_a_time{initial};
+    const double interpreter_ms = measure_ms([&]() {
+        for (std::size_t i = 0; i < n_states; ++i) {
+            State state{};
+            for (const auto& [name, slot]: slots) state[name] = initial[slot][i];
+            interpreter::exec_stmt(stmt, state);
+            for (const auto& [name, slot]: slots) one_at_a_time[slot][i] = state[name];
+        }
+    });
+
+    std::vector<Value> values(slots.size());
+    const double closures_ms = measure_ms([&]() {
+        for (std::size_t i = 0; i < n_states; ++i) {
+            for (unsigned int slot = 0; slot < slots.size(); ++slot) values[slot] = initial[slot][i];
+            closures.run(values.data());
+        }
+    });
+
+    StateColumns lanes_8{}, lanes_16{};
+    const double lanes_8_ms = measure_ms([&]() { lanes_8 = batch.run<8>(initial); });
+    const double lanes_16_ms = measure_ms([&]() { lanes_16 = batch.run<16>(initial); });
+
+    std::cout << "Batch benchmark (" << n_states << " states):\n";
+    std::cout << "\tinterpreter: " << interpreter_ms << " ms (" << (n_states / interpreter_ms) << " states/ms)\n";
+    print_speedup("closures", interpreter_ms, closures_ms);
+    print_speedup("8 lanes", interpreter_ms, lanes_8_ms);
+    print_speedup("16 lanes", interpreter_ms, lanes_16_ms);
+    if (lanes_8 != one_at_a_time || lanes_16 != one_at_a_time) std::cout << "\tresults differ!\n";
+}
+
+
+/*
+ * Same workload as benchmark_jit for the C backend, also reports the cost of a cold and a cached load.
+ */
+void benchmark_c_backend(const Stmt* stmt, unsigned int runs = 100000) {
+    const auto cache_dir = std::filesystem::temp_directory_path() / ("sdpa-bench-" + std::to_string(getpid()));
+
+    const double cold_ms = measure_ms([&]() { CProgram program{stmt, cache_dir}; });
+    std::optional<CProgram> cached{};
+    const double cached_ms = measure_ms([&]() { cached.emplace(stmt, cache_dir); });
+    const auto& slots = cached->slots();
+
+    Value checksum_interpreter = 0;
+    const double interpreter_ms = interpreter_baseline(stmt, slots, runs, checksum_interpreter);
+
+    Value checksum_c = 0;
+    std::vector<Value> values(slots.size());
+    const double c_ms = measure_ms([&]() {
+        for (unsigned int i = 0; i < runs; ++i) {
+            std::fill(values.begin(), values.end(), i % 16);
+            cached->run(values.data());
+            for (const auto value: values) checksum_c += value;
+        }
+    });
+
+    std::cout << "C backend benchmark (" << runs << " runs):\n";
+    std::cout << "\tcompile and load: " << cold_ms << " ms, cached load: " << cached_ms << " ms"
+              << (cached->cache_hit() ? "" : " (cache miss!)") << "\n";
+    std::cout << "\tinterpreter: " << interpreter_ms << " ms\n";
+    print_speedup("c", interpreter_ms, c_ms);
+    if (checksum_interpreter != checksum_c) std::cout << "\tresults differ!\n";
+
+    cached.reset();
+    std::filesystem::remove_all(cache_dir);
+}
+
+
+/*
+ * Specializes the program to the known variables and compares original and residual program,
+ * both when executed (remaining variables set to i % 16 in run i) and when analyzed by LiveVariableAnalysis.
+ */
+void benchmark_partial_evaluation(const Stmt* stmt, const State& known, unsigned int runs = 100000) {
+    PartialEvaluator evaluator{known};
+    std::unique_ptr<Stmt> residual{};
+    const double specialize_ms = measure_ms([&]() { residual = evaluator.specialize(stmt); });
+
+    const auto slots = interpreter::var_slots(stmt);
+    const auto make_input = [&](unsigned int i) {
+        State state{known};
+        for (const auto& [name, slot]: slots) state.try_emplace(name, i % 16);
+        return state;
+    };
+
+    bool same_results = true;
+    const auto time_runs = [&](const Stmt* program, std::vector<State>& results) {
+        return measure_ms([&]() {
+            for (unsigned int i = 0; i < runs; ++i) {
+                auto state = make_input(i);
+                interpreter::exec_stmt(program, state);
+                if (i < 1000) results.push_back(std::move(state));
+            }
+        });
+    };
+
+    std::vector<State> original_results{}, residual_results{};
+    const double original_ms = time_runs(stmt, original_results);
+    const double residual_ms = time_runs(residual.get(), residual_results);
+    for (std::size_t i = 0; i < original_results.size(); ++i) {
+        for (const auto& [name, slot]: slots) {
+            if (original_results[i][name] != residual_results[i][name]) same_results = false;
+        }
+    }
+
+    const double original_lv_ms = measure_ms([&]() { auto res = LiveVariableAnalysis{stmt}.compute(); });
+    const double residual_lv_ms = measure_ms([&]() { auto res = LiveVariableAnalysis{residual.get()}.compute(); });
+
+    std::cout << "Partial evaluation benchmark (specialized in " << specialize_ms << " ms, "
+              << dfa_utils::program_points(stmt).size() << " -> "
+              << dfa_utils::program_points(residual.get()).size() << " program points):\n";
+    std::cout << "\tinterpreter on original: " << original_ms << " ms\n";
+    print_speedup("interpreter on residual", original_ms, residual_ms);
+    std::cout << "\tLV on original: " << original_lv_ms << " ms\n";
+    print_speedup("LV on residual", original_lv_ms, residual_lv_ms);
+    if (!same_results) std::cout << "\tresults differ!\n";
+}
+
+/*
+ * Compares the sequential round-robin LV-analysis with the parallel Jacobi iteration and
+ * the SCC-decomposed solvers for each thread count.
+ */
+void benchmark_parallel_lv(const Stmt* stmt, const std::vector<unsigned int>& thread_counts = {1, 2, 4, 8}) {
+    const LiveVariableAnalysis lv{stmt};
+
+    unsigned int iterations = 0;
+    LiveVariablesVec expected{};
+    const double sequential_ms = measure_ms([&]() { expected = lv.compute(iterations); });
+
+    std::cout << "Parallel LV benchmark (" << dfa_utils::program_points(stmt).size() << " program points, "
+              << iterations << " iterations):\n";
+    std::cout << "\tsequential: " << sequential_ms << " ms\n";
+
+    for (const auto n_threads: thread_counts) {
+        ThreadPool pool{n_threads};
+        LiveVariablesVec result{};
+        const double parallel_ms = measure_ms([&]() { result = lv.compute_parallel(pool, iterations); });
+
+        print_speedup(std::to_string(n_threads) + " threads", sequential_ms, parallel_ms);
+        if (!LiveVariableAnalysis::fixpoint_reached(expected, result)) std::cout << "\tresults differ!\n";
+    }
+
+    LiveVariablesVec result{};
+    const double scc_ms = measure_ms([&]() { result = lv.compute_scc(iterations); });
+    print_speedup("SCC (" + std::to_string(iterations) + " passes in the largest component)", sequential_ms, scc_ms);
+    if (!LiveVariableAnalysis::fixpoint_reached(expected, result)) std::cout << "\tresults differ!\n";
+
+    for (const auto n_threads: thread_counts) {
+        ThreadPool pool{n_threads};
+        const double parallel_ms = measure_ms([&]() { result = lv.compute_scc_parallel(pool, iterations); });
+
+        print_speedup("SCC, " + std::to_string(n_threads) + " threads", sequential_ms, parallel_ms);
+        if (!LiveVariableAnalysis::fixpoint_reached(expected, result)) std::cout << "\tresults differ!\n";
+    }
+}
+
+/*
+ * Runs every sequential LV solver and reports its iteration count and time against round-robin.
+ */
+void benchmark_lv_solvers(const Stmt* stmt) {
+    const LiveVariableAnalysis lv{stmt};
+
+    unsigned int iterations = 0;
+    LiveVariablesVec expected{};
+    const double round_robin_ms = measure_ms([&]() { expected = lv.compute(LVSolver::RoundRobin, iterations); });
+
+    std::cout << "LV solver benchmark (" << dfa_utils::program_points(stmt).size() << " program points):\n";
+    std::cout << "\tround-robin: " << round_robin_ms << " ms, " << iterations << " iterations\n";
+
+    for (const auto solver: {LVSolver::SCC, LVSolver::WTO, LVSolver::Structural, LVSolver::Delta,
+                              LVSolver::BasicBlocks, LVSolver::HashConsed, LVSolver::Indexed}) {
+        LiveVariablesVec result{};
+        const double ms = measure_ms([&]() { result = lv.compute(solver, iterations); });
+
+        print_speedup(lv_solver_name(solver) + " (" + std::to_string(iterations) + " iterations)", round_robin_ms, ms);
+        if (!LiveVariableAnalysis::fixpoint_reached(expected, result)) std::cout << "\tresults differ!\n";
+    }
+}
+
+/*
+ * Sets every k-th assignment of the program to 0, one edit after another, and compares each incremental
+ * update with lexing, parsing and analyzing the whole program again.
+ */
+void benchmark_incremental_lv(const std::string& text, unsigned int n_edits = 100) {
+    const auto parse = [](const std::string& program) {
+        Lexer lexer{program};
+        Parser parser{lexer.tokenize()};
+        return parser.parse();
+    };
+
+    unsigned int iterations = 0;
+    const double full_ms = measure_ms([&]() {
+        const auto stmt = parse(text);
+        auto res = LiveVariableAnalysis{stmt.get()}.compute(LVSolver::WTO, iterations);
+    });
+
+    IncrementalLV incremental{parse(text)};
+    const auto block_set = dfa_utils::blocks(incremental.program());
+    const std::vector<const Block*> blocks{block_set.begin(), block_set.end()};
+    const PP n = blocks.size();
+    std::vector<Edit> edits{};
+    for (PP pp = 1; pp <= n && edits.size() < n_edits; pp += std::max<PP>(n / n_edits, 1)) {
+        if (blocks[pp - 1]->kind_ == BlockKind::Assign) {
+            const auto a = static_cast<const Assign*>(blocks[pp - 1]);
+            edits.push_back({ pp, "[" + a->var_->name_ + " := 0]^" + std::to_string(pp) });
+        }
+    }
+    if (edits.empty()) return;
+
+    unsigned long visits = 0;
+    const double incremental_ms = measure_ms([&]() {
+        for (const auto& edit: edits) visits += incremental.apply(edit);
+    });
+
+    const auto expected = LiveVariableAnalysis{incremental.program()}.compute(LVSolver::WTO, iterations);
+
+    std::cout << "Incremental LV benchmark (" << n << " program points, " << edits.size() << " edits):\n";
+    std::cout << "\tfull reanalysis: " << full_ms << " ms per edit\n";
+    print_speedup("incremental (" + std::to_string(visits / edits.size()) + " visits per edit)",
+                  full_ms, incremental_ms / edits.size());
+    if (!LiveVariableAnalysis::fixpoint_reached(expected, incremental.result())) std::cout << "\tresults differ!\n";
+}
+
+/*
+ * Renames the assigned variable of evenly spaced statements, one edit after another, and compares
+ * relexing and reparsing the damaged region with lexing and parsing the whole edited text.
+ */
+void benchmark_incremental_parsing(const std::string& text, unsigned int n_edits = 100) {
+    IncrementalParser incremental{text};
+
+    std::vector<TextEdit> edits{};
+    for (std::size_t pos = 0; edits.size() < n_edits; pos += text.size() / n_edits) {
+        const auto bracket = text.find('[', pos);
+        if (bracket == std::string::npos) break;
+        if (std::isalpha(text[bracket + 1]) && text.compare(bracket + 1, 4, "skip") != 0) {
+            // Edits are applied in order, earlier ones shifted the text by one character each
+            edits.push_back({ bracket + 1 + edits.size(), 0, "q" });
+        }
+    }
+    if (edits.empty()) return;
+
+    std::string edited = text;
+    const double full_ms = measure_ms([&]() {
+        for (const auto& edit: edits) {
+            edited.insert(edit.offset_, edit.text_);
+            Lexer lexer{edited};
+            Parser parser{lexer.tokenize()};
+            const auto stmt = parser.parse();
+        }
+    });
+
+    std::size_t reparsed = 0;
+    const double incremental_ms = measure_ms([&]() {
+        for (const auto& edit: edits) reparsed += incremental.apply(edit).reparsed_tokens_;
+    });
+
+    std::stringstream expected{}, result{};
+    {
+        Lexer lexer{edited};
+        Parser parser{lexer.tokenize()};
+        ASTSourcePrinter{expected}.print(*parser.parse());
+        ASTSourcePrinter{result}.print(*incremental.program());
+    }
+
+    std::cout << "Incremental parsing benchmark (" << incremental.tokens().size() << " tokens, " << edits.size() << " edits):\n";
+    std::cout << "\tlex and parse: " << full_ms / edits.size() << " ms per edit\n";
+    print_speedup("incremental (" + std::to_string(reparsed / edits.size()) + " tokens reparsed per edit)",
+                  full_ms / edits.size(), incremental_ms / edits.size());
+    if (edited != incremental.text() || expected.str() != result.str()) std::cout << "\tresults differ!\n";
+}
+
+/*
+ * Program info and structural LV from scratch, with an empty summary cache and with the cache saved to disk
+ * and loaded again, as a second run would.
+ */
+void benchmark_summary_cache(const Stmt* stmt) {
+    const auto path = std::filesystem::temp_directory_path() / "sdpa_summaries_bench.bin";
+    std::filesystem::remove(path);
+
+    unsigned int iterations = 0;
+    ProgramInfo expected_info{};
+    LiveVariablesVec expected{};
+    const double full_ms = measure_ms([&]() {
+        expected_info = dfa_utils::program_info(stmt);
+        expected = LiveVariableAnalysis{stmt, expected_info}.compute_structural(iterations);
+    });
+
+    std::cout << "Summary cache benchmark (" << expected_info.pps_.size() << " program points):\n";
+    std::cout << "\tprogram info and structural LV: " << full_ms << " ms\n";
+
+    for (const bool warm: {false, true}) {
+        SummaryCache cache{path};
+        ProgramInfo info{};
+        LiveVariablesVec result{};
+        const double ms = measure_ms([&]() {
+            info = cache.program_info(stmt);
+            result = LiveVariableAnalysis{stmt, info}.compute_structural(iterations, cache);
+        });
+        cache.save();
+
+        print_speedup(std::string{warm ? "warm" : "cold"} + " cache (" + std::to_string(cache.hits()) + " hits, "
+                      + std::to_string(cache.misses()) + " misses)", full_ms, ms);
+        if (info.pps_ != expected_info.pps_ || info.cf_ != expected_info.cf_ || info.final_pps_ != expected_info.final_pps_
+            || !LiveVariableAnalysis::fixpoint_reached(expected, result)) {
+            std::cout << "\tresults differ!\n";
+        }
+    }
+
+    std::filesystem::remove(path);
+}
+
+/*
+ * Loads the program from its binary AST, from memory and mapped from a file, and compares with lexing and
+ * parsing the text.
+ */
+void benchmark_ast_loading(const std::string& text, unsigned int runs = 20) {
+    std::unique_ptr<Stmt> parsed{};
+    const double parse_ms = measure_ms([&]() {
+        for (unsigned int i = 0; i < runs; ++i) {
+            Lexer lexer{text};
+            Parser parser{lexer.tokenize()};
+            parsed = parser.parse();
+        }
+    }) / runs;
+
+    const auto data = ast_binary::write(parsed.get());
+    const auto path = std::filesystem::temp_directory_path() / "sdpa_ast_bench.wlb";
+    ast_binary::write_file(parsed.get(), path);
+
+    std::unique_ptr<Stmt> read{};
+    const double read_ms = measure_ms([&]() {
+        for (unsigned int i = 0; i < runs; ++i) read = ast_binary::read(data);
+    }) / runs;
+
+    std::unique_ptr<Stmt> mapped{};
+    const double mapped_ms = measure_ms([&]() {
+        for (unsigned int i = 0; i < runs; ++i) mapped = ast_binary::read_file(path);
+    }) / runs;
+    std::filesystem::remove(path);
+
+    std::cout << "AST loading benchmark (" << text.size() << " bytes of text, " << data.size() << " bytes binary):\n";
+    std::cout << "\tlex and parse: " << parse_ms << " ms\n";
+    print_speedup("binary AST from memory", parse_ms, read_ms);
+    print_speedup("binary AST mapped from file", parse_ms, mapped_ms);
+    if (ast_binary::write(read.get()) != data || ast_binary::write(mapped.get()) != data) std::cout << "\tresults differ!\n";
+}
+
+/*
+ * Compares the LV result store with the text of print_result: file size, loading every set (the text parsed
+ * back as a downstream tool would) and random single queries against the mapped store.
+ */
+void benchmark_result_store(const Stmt* stmt, unsigned int n_queries = 100000) {
+    unsigned int iterations = 0;
+    const auto lvs = LiveVariableAnalysis{stmt}.compute(LVSolver::Structural, iterations);
+
+    const auto text_path = std::filesystem::temp_directory_path() / "sdpa_result_bench.txt";
+    const auto store_path = std::filesystem::temp_directory_path() / "sdpa_result_bench.lvs";
+    {
+        std::ofstream text{text_path};
+        LiveVariableAnalysis::print_result(lvs, text);
+    }
+    LVResultStore::write(lvs, store_path);
+
+    std::vector<std::vector<std::string>> parsed{};
+    const double text_ms = measure_ms([&]() {
+        std::ifstream text{text_path};
+        std::string line{};
+        std::getline(text, line);
+        while (std::getline(text, line)) {
+            std::stringstream words{line.substr(line.find('{') + 1)};
+            auto& row = parsed.emplace_back();
+            for (std::string word{}; words >> word && word != "}";) row.push_back(word);
+        }
+    });
+
+    std::vector<std::vector<unsigned int>> decoded{};
+    const double store_ms = measure_ms([&]() {
+        const LVResultStore store{store_path};
+        for (PP pp = 1; pp <= store.n_pps(); ++pp) {
+            decoded.push_back(store.entry(pp));
+            decoded.push_back(store.exit(pp));
+        }
+    });
+    const auto loaded = LVResultStore{store_path}.materialize();
+
+    const LVResultStore store{store_path};
+    std::size_t live = 0;
+    const double query_ms = measure_ms([&]() {
+        for (unsigned int i = 0; i < n_queries; ++i) {
+            const PP pp = 1 + (i * 7919u) % store.n_pps();
+            if (!store.variables().empty()) live += store.live_at_entry(pp, store.variables()[i % store.variables().size()]);
+        }
+    });
+
+    std::cout << "LV result store benchmark (" << lvs.size() / 2 << " program points):\n";
+    std::cout << "\ttext: " << std::filesystem::file_size(text_path) << " bytes, parsed in " << text_ms << " ms\n";
+    std::cout << "\tstore: " << std::filesystem::file_size(store_path) << " bytes\n";
+    print_speedup("store mapped and decoded", text_ms, store_ms);
+    std::cout << "\t" << n_queries << " random queries: " << query_ms << " ms (" << live << " live)\n";
+    if (!LiveVariableAnalysis::fixpoint_reached(lvs, loaded) || parsed.size() != decoded.size()) std::cout << "\tresults differ!\n";
+
+    std::filesystem::remove(text_path);
+    std::filesystem::remove(store_path);
+}
+
+/*
+ * Round-robin on independent sets against round-robin on hash-consed sets: time and the number of set elements
+ * the solution keeps in memory.
+ */
+void benchmark_hash_consed_lv(const Stmt* stmt) {
+    const LiveVariableAnalysis lv{stmt};
+
+    unsigned int iterations = 0;
+    LiveVariablesVec expected{};
+    const double round_robin_ms = measure_ms([&]() { expected = lv.compute(iterations); });
+
+    std::size_t elements = 0;
+    for (const auto& set: expected) elements += set.size();
+
+    unsigned int shared_iterations = 0;
+    std::unique_ptr<LVSharedSolution> shared{};
+    const double shared_ms = measure_ms([&]() {
+        shared = std::make_unique<LVSharedSolution>(lv.compute_hash_consed(shared_iterations));
+    });
+
+    std::cout << "Hash-consed LV benchmark (" << expected.size() / 2 << " program points):\n";
+    std::cout << "\tround-robin: " << round_robin_ms << " ms, " << iterations << " iterations, "
+              << elements << " set elements in " << expected.size() << " sets\n";
+    print_speedup("hash-consed (" + std::to_string(shared_iterations) + " iterations)", round_robin_ms, shared_ms);
+    std::cout << "\thash-consed: " << shared->table().stored_elements() << " set elements in "
+              << shared->table().size() << " distinct sets, " << shared->table().memo_hits() << " memo hits\n";
+    if (!LiveVariableAnalysis::fixpoint_reached(expected, shared->materialize())) std::cout << "\tresults differ!\n";
+}
+
+/*
+ * Runs LiveVariableAnalysis::solve_indexed on Set, prints time and bytes of the solution and compares it.
+ */
+template<typename Set>
+void report_indexed_lv(const LiveVariableAnalysis& lv, const VarIndex& index, const LiveVariablesVec& expected,
+                       const std::string& name, double baseline_ms) {
+    unsigned int iterations = 0;
+    std::vector<Set> sets{};
+    const double ms = measure_ms([&]() { sets = lv.solve_indexed<Set>(index, iterations); });
+
+    std::size_t bytes = 0;
+    for (const auto& set: sets) bytes += sizeof(Set) + set.bytes();
+
+    print_speedup(name + " (" + std::to_string(iterations) + " iterations)", baseline_ms, ms);
+    std::cout << "\t" << name << ": " << bytes << " bytes\n";
+
+    for (std::size_t i = 0; i < sets.size(); ++i) {
+        if (!var_ptr_set_equality(expected[i], index.to_set(sets[i]))) {
+            std::cout << "\tresults differ!\n";
+            return;
+        }
+    }
+}
+
+/*
+ * Round-robin on std::set against the same iteration on dense bitsets and on compressed sparse sets of variable
+ * indices: time and the bytes the solution takes. Fixed-size bitsets run as far as the variables fit, dense sets
+ * are skipped once they would need more than 1 GiB.
+ */
+void benchmark_indexed_lv(const Stmt* stmt) {
+    const LiveVariableAnalysis lv{stmt};
+    const VarIndex index{dfa_utils::free_variables_stmt(stmt)};
+
+    unsigned int iterations = 0;
+    LiveVariablesVec expected{};
+    const double round_robin_ms = measure_ms([&]() { expected = lv.compute(iterations); });
+
+    std::size_t elements = 0;
+    for (const auto& set: expected) elements += set.size();
+
+    std::cout << "Indexed LV benchmark (" << expected.size() / 2 << " program points, " << index.size() << " variables):\n";
+    std::cout << "\tround-robin: " << round_robin_ms << " ms, " << iterations << " iterations, "
+              << elements << " set elements\n";
+
+    if (index.size() <= FixedVarSet<1>::max_vars) report_indexed_lv<FixedVarSet<1>>(lv, index, expected, "fixed<1>", round_robin_ms);
+    if (index.size() <= FixedVarSet<2>::max_vars) report_indexed_lv<FixedVarSet<2>>(lv, index, expected, "fixed<2>", round_robin_ms);
+    if (index.size() <= FixedVarSet<4>::max_vars) report_indexed_lv<FixedVarSet<4>>(lv, index, expected, "fixed<4>", round_robin_ms);
+    if (expected.size() * ((index.size() + 63) / 64 * 8) <= std::size_t{1} << 30) {
+        report_indexed_lv<DenseVarSet>(lv, index, expected, "dense", round_robin_ms);
+    }
+    report_indexed_lv<SparseVarSet>(lv, index, expected, "sparse", round_robin_ms);
+}
+
+/*
+ * Runs f with a counting default resource and prints its time, the allocations of analysis containers that reached
+ * the default resource and how much the peak RSS grew. Runs in a child process where possible, so the peak is not
+ * the one of an earlier measurement.
+ */
+template<typename F>
+void report_analysis_memory(const std::string& name, F&& f) {
+    const auto measure = [&]() {
+        const auto rss_kb = analysis_memory::peak_rss_kb();
+        analysis_memory::CountingResource counter{};
+        auto* previous = std::pmr::set_default_resource(&counter);
+        const double ms = measure_ms(f);
+        std::pmr::set_default_resource(previous);
+
+        std::cout << "\t" << name << ": " << ms << " ms, " << counter.allocations() << " allocations ("
+                  << counter.bytes() << " bytes), peak RSS +" << analysis_memory::peak_rss_kb() - rss_kb << " KiB\n";
+    };
+
+#ifdef SDPA_FORK
+    std::cout.flush();
+    if (const auto pid = fork(); pid == 0) {
+        measure();
+        std::cout.flush();
+        _exit(0);
+    } else if (pid > 0) {
+        waitpid(pid, nullptr, 0);
+        return;
+    }
+#endif
+    measure();
+}
+
+/*
+ * Construction and round-robin LV with every container node taken from the heap, as before the analyses had
+ * arenas, against the analysis with its arena and iteration-scoped arenas.
+ */
+void benchmark_analysis_memory(const Stmt* stmt) {
+    std::cout << "Analysis memory benchmark (" << dfa_utils::program_points(stmt).size() << " program points):\n";
+
+    report_analysis_memory("heap", [stmt]() {
+        LiveVariableAnalysis::check_constraints(stmt);
+        const LiveVariableAnalysis lv{stmt, dfa_utils::program_info(stmt)};
+
+        LiveVariablesVec vec(dfa_utils::program_points(stmt).size() * 2);
+        LiveVariablesVec prev_vec{vec};
+        while (true) {
+            vec = lv.F_LV(vec);
+            if (LiveVariableAnalysis::fixpoint_reached(prev_vec, vec)) break;
+            prev_vec = vec;
+        }
+    });
+
+    report_analysis_memory("arenas", [stmt]() {
+        unsigned int iterations = 0;
+        const auto vec = LiveVariableAnalysis{stmt}.compute(iterations);
+    });
+}
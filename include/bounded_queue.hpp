@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+
+
+/**
+ * Bounded lock-free multi-producer multi-consumer queue (Dmitry Vyukov's array-based design).
+ *
+ * Every cell carries a sequence number that tells producers and consumers whether the cell is free
+ * for the current lap. Producers and consumers claim positions with a CAS on their own counter and
+ * never touch the same cell concurrently. The capacity is rounded up to a power of two.
+ *
+ * try_push fails when the queue is full, which is how the pipeline stages get backpressure.
+ */
+template<typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(std::size_t capacity) {
+        if (capacity == 0) throw std::invalid_argument("Queue capacity must not be zero!");
+
+        capacity_ = 1;
+        while (capacity_ < capacity) capacity_ <<= 1;
+        mask_ = capacity_ - 1;
+
+        cells_ = std::make_unique<Cell[]>(capacity_);
+        for (std::size_t i = 0; i < capacity_; ++i) cells_[i].sequence_.store(i, std::memory_order_relaxed);
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue(BoundedQueue&&) = delete;
+    auto operator=(const BoundedQueue&) -> BoundedQueue& = delete;
+    auto operator=(BoundedQueue&&) -> BoundedQueue& = delete;
+
+    /*
+     * Moves the value into the queue, leaves it untouched and returns false if the queue is full.
+     */
+    bool try_push(T& value) {
+        std::size_t pos = tail_.load(std::memory_order_relaxed);
+        Cell* cell;
+
+        while (true) {
+            cell = &cells_[pos & mask_];
+            const std::size_t seq = cell->sequence_.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            }
+            else if (diff < 0) return false;
+            else pos = tail_.load(std::memory_order_relaxed);
+        }
+
+        cell->value_ = std::move(value);
+        cell->sequence_.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::optional<T> try_pop() {
+        std::size_t pos = head_.load(std::memory_order_relaxed);
+        Cell* cell;
+
+        while (true) {
+            cell = &cells_[pos & mask_];
+            const std::size_t seq = cell->sequence_.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            }
+            else if (diff < 0) return std::nullopt;
+            else pos = head_.load(std::memory_order_relaxed);
+        }
+
+        std::optional<T> value{std::move(cell->value_)};
+        cell->sequence_.store(pos + capacity_, std::memory_order_release);
+        return value;
+    }
+
+    /*
+     * Approximate number of elements, only meant for statistics.
+     */
+    [[nodiscard]] std::size_t size() const {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+    [[nodiscard]] std::size_t capacity() const { return capacity_; }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence_;
+        T value_;
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    std::size_t capacity_;
+    std::size_t mask_;
+
+    // Producers and consumers on separate cache lines
+    alignas(64) std::atomic<std::size_t> tail_{0};
+    alignas(64) std::atomic<std::size_t> head_{0};
+};
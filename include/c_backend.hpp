@@ -0,0 +1,63 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+#include "ast.hpp"
+#include "interpreter.hpp"
+
+
+/**
+ * Native backend that transpiles a WL program to C, compiles it with the local C compiler into a
+ * shared object and loads it with dlopen.
+ *
+ * The generated code is one function wl_run(struct wl_state*), where wl_state has an int64_t field per
+ * variable from dfa_utils::free_variables_stmt, laid out in slot order. Compiled objects are cached
+ * on disk under a hash of the generated source, so repeated runs of the same program skip compilation.
+ *
+ * The compiler is the one CMake was configured with (clang), it can be overridden by the SDPA_CC
+ * environment variable. The cache directory defaults to $SDPA_CACHE_DIR, $XDG_CACHE_HOME/sdpa or
+ * ~/.cache/sdpa.
+ */
+class CProgram {
+public:
+    explicit CProgram(const Stmt* stmt);
+    CProgram(const Stmt* stmt, std::filesystem::path cache_dir);
+    ~CProgram();
+
+    CProgram(const CProgram&) = delete;
+    CProgram(CProgram&&) = delete;
+    auto operator=(const CProgram&) -> CProgram& = delete;
+    auto operator=(CProgram&&) -> CProgram& = delete;
+
+    /*
+     * Executes the program on the given slot array, which must hold slots().size() values.
+     */
+    void run(Value* state) const { fn_(state); }
+
+    [[nodiscard]] State run(const State& state) const;
+
+    [[nodiscard]] const VarSlots& slots() const { return slots_; }
+    [[nodiscard]] const std::string& source() const { return source_; }
+    [[nodiscard]] const std::filesystem::path& object_path() const { return object_path_; }
+
+    /*
+     * Whether the shared object was found in the cache instead of being compiled.
+     */
+    [[nodiscard]] bool cache_hit() const { return cache_hit_; }
+
+    [[nodiscard]] static std::string emit_c(const Stmt* stmt, const VarSlots& slots);
+    [[nodiscard]] static std::filesystem::path default_cache_dir();
+
+private:
+    using CompiledFn = void (*)(Value*);
+
+    VarSlots slots_;
+    std::string source_;
+    std::filesystem::path object_path_;
+    bool cache_hit_;
+    void* handle_;
+    CompiledFn fn_;
+
+    void compile(const std::string& compiler) const;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <functional>
+
+#include "ast.hpp"
+#include "interpreter.hpp"
+
+
+// Compiled closures operate on the slot array of the program
+using StmtClosure = std::function<void(Value*)>;
+using AExpClosure = std::function<Value(const Value*)>;
+using BExpClosure = std::function<bool(const Value*)>;
+
+
+/**
+ * Pre-compiles a WL program into a tree of closures.
+ *
+ * Variables are resolved to slots and operators to dedicated lambdas ahead of time, so executing
+ * the program neither visits the AST nor compares operator strings. Common shapes such as
+ * x := n, x := (y op n) and (x opr n) get their own specialized closures.
+ */
+class ClosureProgram {
+public:
+    explicit ClosureProgram(const Stmt* stmt);
+
+    ClosureProgram(const ClosureProgram&) = delete;
+    ClosureProgram(ClosureProgram&&) = delete;
+    auto operator=(const ClosureProgram&) -> ClosureProgram& = delete;
+    auto operator=(ClosureProgram&&) -> ClosureProgram& = delete;
+
+    /*
+     * Executes the program on the given slot array, which must hold slots().size() values.
+     */
+    void run(Value* state) const { body_(state); }
+
+    [[nodiscard]] State run(const State& state) const;
+
+    [[nodiscard]] const VarSlots& slots() const { return slots_; }
+
+private:
+    VarSlots slots_;
+    StmtClosure body_;
+
+    [[nodiscard]] StmtClosure compile_stmt(const Stmt* stmt) const;
+    [[nodiscard]] StmtClosure compile_assign(const Assign& assign) const;
+    [[nodiscard]] AExpClosure compile_aexp(const AExp* aexp) const;
+    [[nodiscard]] BExpClosure compile_bexp(const BExp* bexp) const;
+    [[nodiscard]] BExpClosure compile_relational(const RelationalOp& opr) const;
+
+    void flatten_seq(const Stmt* stmt, std::vector<StmtClosure>& out) const;
+};
@@ -3,6 +3,7 @@
 #include <set>
 #include <algorithm>
 #include <utility>
+#include <vector>
 
 #include "utils.hpp"
 #include "set_utils.hpp"
@@ -16,7 +17,7 @@ namespace dfa_utils {
     FreeVariables free_variables_bexp(const BExp* bexp);
     FreeVariables free_variables_stmt(const Stmt* stmt);
 
-    std::set<PP> program_points(const Stmt* stmt);
+    ProgramPoints program_points(const Stmt* stmt);
 
     /**
      * Returns the elementary block for the given program point.
@@ -29,19 +30,50 @@ namespace dfa_utils {
     unsigned int pp_occurences(const Stmt* stmt, const PP pp);
     PP initial_pp(const Stmt* stmt);
     bool is_initial_pp(const Stmt* stmt, const PP pp);
-    std::set<PP> final_pps(const Stmt* stmt);
+    ProgramPoints final_pps(const Stmt* stmt);
     bool is_final_pp(const Stmt* stmt, const PP pp);
 
     CFG control_flow(const Stmt* stmt);
 
+    /**
+     * Program points, control flow and final program points in one go.
+     */
+    ProgramInfo program_info(const Stmt* stmt);
+
     bool has_isolated_entries(const Stmt* stmt);
     bool has_isolated_exits(const Stmt* stmt);
 
+    /**
+     * Strongly connected components of the flow graph (Tarjan).
+     * A component is emitted only after every component reachable from it, i.e. in reverse topological order,
+     * which is the order in which a backward analysis can solve them.
+     */
+    std::vector<std::vector<PP>> strongly_connected_components(const ProgramPoints& pps, const CFG& cf);
+
+    /**
+     * Weak topological order of the flow graph from the given roots (Bourdoncle's hierarchical decomposition).
+     * Every cycle contains the head of a component, heads come before the rest of their loop.
+     * Program points not reachable from the roots are ordered before the program points they lead to.
+     * The search is iterative, the depth of the result (and of the solvers walking it) is the nesting depth of loops.
+     */
+    WTO weak_topological_order(const ProgramPoints& pps, const CFG& cf, const ProgramPoints& roots);
+
+    /**
+     * The flow graph with every edge reversed, backward analyses follow the flow in this direction.
+     */
+    CFG reverse_flow(const CFG& cf);
+
+    /**
+     * Maximal basic blocks of the flow graph: chains of program points where each one is the only successor of
+     * the previous one and the previous one is its only predecessor. Blocks are sorted by their first program point.
+     */
+    std::vector<std::vector<PP>> basic_blocks(const ProgramPoints& pps, const CFG& cf);
+
 
     namespace io {
         // Printer methods
         void print_var_set(const FreeVariables& vars);
-        void print_pp_set(const std::set<PP>& pps);
+        void print_pp_set(const ProgramPoints& pps);
         void print_block_set(const ElementaryBlocks& blocks);
         void print_cf_set(const CFG& cf);
     }
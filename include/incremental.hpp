@@ -0,0 +1,67 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ast.hpp"
+#include "lv.hpp"
+
+
+/**
+ * An edit of a single elementary block, identified by its program point.
+ * Skips and assignments are replaced by a statement, e.g. "[x := 0]^5" or "[x := 0]^5; [y := x]^12",
+ * which keeps the program point and numbers new ones after the last one of the program.
+ * Conditions of ifs and whiles are replaced by a condition with the same program point, e.g. "[(x > 0)]^3".
+ */
+struct Edit {
+    PP pp_;
+    std::string text_;
+};
+
+
+/**
+ * Keeps a program and its LV solution up to date while it is edited.
+ *
+ * Only the text of an edit is lexed and parsed. The new subtree is spliced into the AST in place of the
+ * edited block, the flow graph of the analysis is patched around it, and the previous solution is repaired
+ * starting from the program points that could be affected (see LiveVariableAnalysis::repair) instead of
+ * solving from an empty vector. Replaced subtrees are retired rather than destroyed, since the variables
+ * in the solution may still point into them.
+ */
+class IncrementalLV {
+private:
+    std::unique_ptr<Stmt> program_;
+    LiveVariableAnalysis lv_;
+    LiveVariablesVec vec_;
+    std::vector<std::unique_ptr<Stmt>*> statements_;   // Slot of the skip or assignment at program point i + 1
+    std::vector<std::unique_ptr<Cond>*> conditions_;   // ... or of the condition, nullptr otherwise
+    std::vector<std::unique_ptr<Stmt>> retired_statements_;
+    std::vector<std::unique_ptr<Cond>> retired_conditions_;
+
+public:
+    /*
+     * Analyzes the whole program once.
+     */
+    explicit IncrementalLV(std::unique_ptr<Stmt> program);
+
+    IncrementalLV(const IncrementalLV&) = delete;
+    IncrementalLV(IncrementalLV&&) = delete;
+    auto operator=(const IncrementalLV&) -> IncrementalLV& = delete;
+    auto operator=(IncrementalLV&&) -> IncrementalLV& = delete;
+
+    /*
+     * Applies the edit and updates the solution, returns the number of program points visited.
+     * Throws and leaves program and solution unchanged if the edit does not fit the program.
+     */
+    unsigned int apply(const Edit& edit);
+
+    [[nodiscard]] const Stmt* program() const { return program_.get(); }
+    [[nodiscard]] const LiveVariablesVec& result() const { return vec_; }
+
+private:
+    /*
+     * Records the slots of the elementary blocks in the subtree held by slot.
+     */
+    void index(std::unique_ptr<Stmt>& slot);
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ast.hpp"
+#include "parser.hpp"
+#include "token.hpp"
+
+
+/**
+ * Replaces length_ characters of the text at offset_ by text_.
+ */
+struct TextEdit {
+    std::size_t offset_;
+    std::size_t length_;
+    std::string text_;
+};
+
+struct ReparseStats {
+    std::size_t relexed_tokens_;        // Tokens lexed again
+    std::size_t reparsed_tokens_;       // Tokens parsed again, 0 if the tokens did not change
+};
+
+
+/**
+ * Keeps the tokens and the AST of a program text up to date while the text is edited.
+ *
+ * An edit is relexed from the token before it until the new tokens line up with the old ones again. Only the
+ * smallest part of the program around the damaged tokens that parses on its own is parsed again: a run of
+ * elements of a sequence, the branch of an if or the body of a while, and the enclosing ones up to the whole
+ * program if that fails. All other subtrees are kept as they are, the AST is the same as after parsing the
+ * edited text from scratch.
+ */
+class IncrementalParser {
+private:
+    std::string text_;
+    std::vector<Token> tokens_;
+    std::vector<std::size_t> offsets_;  // Start of every token in the text
+    std::unique_ptr<Stmt> program_;
+    StmtSpans spans_;                   // Span of every statement of the program
+
+public:
+    explicit IncrementalParser(std::string text);
+
+    IncrementalParser(const IncrementalParser&) = delete;
+    IncrementalParser(IncrementalParser&&) = delete;
+    auto operator=(const IncrementalParser&) -> IncrementalParser& = delete;
+    auto operator=(IncrementalParser&&) -> IncrementalParser& = delete;
+
+    /*
+     * Applies the edit to text, tokens and AST.
+     * Throws, e.g. a SyntaxError, and keeps the previous state if the edited text is no program.
+     */
+    ReparseStats apply(const TextEdit& edit);
+
+    [[nodiscard]] const std::string& text() const { return text_; }
+    [[nodiscard]] const std::vector<Token>& tokens() const { return tokens_; }
+    [[nodiscard]] const Stmt* program() const { return program_.get(); }
+
+private:
+    /*
+     * Replaces the old tokens [begin, end) by the relexed ones and takes over the edited text.
+     */
+    void replace_tokens(std::size_t begin, std::size_t end, std::vector<Token> tokens,
+                        const std::vector<std::size_t>& offsets, std::string text, long char_delta);
+};
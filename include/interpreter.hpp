@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "utils.hpp"
+#include "ast.hpp"
+
+
+// Values of WL variables, arithmetic wraps around on overflow
+using Value = std::int64_t;
+// Program state, variables that were never assigned read as 0
+using State = std::unordered_map<std::string, Value>;
+// Dense numbering of the free variables of a program, used by the compiled executors
+using VarSlots = std::unordered_map<std::string, unsigned int>;
+
+
+// Operators as they appear in the AST, resolved once so executors do not compare strings
+enum class ArithmeticOpKind { Add, Sub, Mul };
+enum class RelationalOpKind { Lt, Le, Gt, Ge };
+enum class BooleanOpKind { And, Or };
+
+
+/**
+ * Reference semantics of WL: a plain AST-walking interpreter over a name-keyed state.
+ * It is the baseline the compiled executors are measured against.
+ */
+namespace interpreter {
+    Value eval_aexp(const AExp* aexp, const State& state);
+    bool eval_bexp(const BExp* bexp, const State& state);
+    void exec_stmt(const Stmt* stmt, State& state);
+
+    ArithmeticOpKind arithmetic_op_kind(const std::string& op);
+    RelationalOpKind relational_op_kind(const std::string& op);
+    BooleanOpKind boolean_op_kind(const std::string& op);
+
+    Value apply(ArithmeticOpKind op, Value lhs, Value rhs);
+    bool apply(RelationalOpKind op, Value lhs, Value rhs);
+
+    /**
+     * Assigns every free variable of the statement a slot, in the order of dfa_utils::free_variables_stmt.
+     */
+    VarSlots var_slots(const Stmt* stmt);
+    std::vector<Value> to_slots(const State& state, const VarSlots& slots);
+    State from_slots(const std::vector<Value>& values, const VarSlots& slots);
+}
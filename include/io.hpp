@@ -1,24 +1,85 @@
 #pragma once
 
 #include <fstream>
+#include <iostream>
 #include <sstream>
 #include <filesystem>
 #include <memory>
+#include <string>
+#include <string_view>
 
+
+/**
+ * Program text that is either memory-mapped from a file or owned.
+ * The mapping is read-only and advised for sequential access, the lexer reads it through text()
+ * without copying the source. Binary ASTs (see ast_binary) are mapped the same way.
+ */
+class ProgramSource {
+private:
+    std::string owned_;
+    void* mapping_;
+    std::size_t mapping_size_;
+    std::string_view text_;
+
+public:
+    explicit ProgramSource(std::string text):
+        owned_{std::move(text)}, mapping_{nullptr}, mapping_size_{0}, text_{owned_} {}
+
+    /*
+     * Maps the file, falls back to reading it if it cannot be mapped (e.g. empty files or pipes).
+     */
+    explicit ProgramSource(const std::filesystem::path& path);
+    ~ProgramSource();
+
+    ProgramSource(const ProgramSource&) = delete;
+    ProgramSource(ProgramSource&&) = delete;
+    auto operator=(const ProgramSource&) -> ProgramSource& = delete;
+    auto operator=(ProgramSource&&) -> ProgramSource& = delete;
+
+    [[nodiscard]] std::string_view text() const { return text_; }
+    [[nodiscard]] bool is_mapped() const { return mapping_ != nullptr; }
+};
+
+
+/**
+ * Reads .wlang programs from a file or, given the path "-", from stdin.
+ */
 class WLangReader {
 private:
-    std::ifstream file_;
+    mutable std::ifstream file_;        // Opened on first use, map_program does not need it
+    std::filesystem::path path_;
+    bool stdin_{false};
 
 public:
+    /*
+     * Relative paths are resolved against the parent directory of the executable's directory,
+     * absolute paths and "-" (stdin) are taken as is.
+     */
     explicit WLangReader(char* argv[], const std::string& filename) {
+        if (filename == "-") {
+            stdin_ = true;
+            return;
+        }
+
         if (!filename.ends_with(".wlang")) {
             throw std::runtime_error("Wrong file type!");
         }
 
-        std::filesystem::path exe_path = canonical(std::filesystem::path(argv[0]));
-        std::filesystem::path file_path = exe_path.parent_path().parent_path() / filename;
+        if (std::filesystem::path{filename}.is_absolute()) {
+            path_ = filename;
+        } else {
+            std::filesystem::path exe_path = canonical(std::filesystem::path(argv[0]));
+            path_ = exe_path.parent_path().parent_path() / filename;
+        }
+    }
 
-        file_.open(file_path);
+    /*
+     * Reads the file at the given path as is, relative paths are resolved against the working directory.
+     */
+    explicit WLangReader(const std::filesystem::path& file_path): path_{file_path} {
+        if (file_path.extension() != ".wlang") {
+            throw std::runtime_error("Wrong file type!");
+        }
     }
 
     ~WLangReader() {
@@ -27,6 +88,13 @@ public:
         }
     }
 
+    /*
+     * Opens the file for read_program if that has not happened yet.
+     */
+    [[nodiscard]] bool is_open() const {
+        return stdin_ || open();
+    }
+
     [[nodiscard]] std::string read_program() const {
         std::string program{};
 
@@ -37,15 +105,46 @@ public:
         return program;
     }
 
+    /*
+     * Zero-copy alternative to read_program, maps the file instead of reading it.
+     * Programs from stdin cannot be mapped and are read into the source.
+     */
+    [[nodiscard]] std::unique_ptr<ProgramSource> map_program() const {
+        if (stdin_) return std::make_unique<ProgramSource>(read_file());
+
+        // ProgramSource opens the file itself and throws if it cannot
+        return std::make_unique<ProgramSource>(path_);
+    }
+
 private:
+    bool open() const {
+        if (!file_.is_open()) file_.open(path_);
+        return file_.is_open();
+    }
+
     [[nodiscard]] std::string read_file() const {
-        if (!file_.is_open()) {
+        if (stdin_) {
+            std::stringstream stream{};
+            stream << std::cin.rdbuf();
+            return stream.str();
+        }
+
+        if (!open()) {
             throw std::runtime_error("Error while opening file!");
         }
 
-        std::stringstream buffer{};
-        buffer << file_.rdbuf();
-        return buffer.str();
+        // Read straight into the string when the size is known, no intermediate stringstream
+        auto* buffer = file_.rdbuf();
+        const auto size = buffer->pubseekoff(0, std::ios::end, std::ios::in);
+        if (size < 0) {
+            std::stringstream stream{};
+            stream << buffer;
+            return stream.str();
+        }
+
+        std::string program(static_cast<std::size_t>(size), '\0');
+        buffer->pubseekpos(0, std::ios::in);
+        program.resize(static_cast<std::size_t>(buffer->sgetn(program.data(), size)));
+        return program;
     }
 };
-
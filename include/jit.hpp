@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ast.hpp"
+#include "interpreter.hpp"
+
+
+/**
+ * Template JIT that lowers a WL program to x86-64 machine code in an mmap'd executable buffer.
+ *
+ * The compiled function takes a pointer to the slot array of the program (see interpreter::var_slots)
+ * and updates it in place. Programs with at most five variables keep them in callee-saved registers
+ * for the whole run and only touch the slot array on entry and exit.
+ *
+ * On hosts other than x86-64 Linux no code is generated and run() falls back to the interpreter.
+ */
+class JitProgram {
+public:
+    explicit JitProgram(const Stmt* stmt);
+    ~JitProgram();
+
+    JitProgram(const JitProgram&) = delete;
+    JitProgram(JitProgram&&) = delete;
+    auto operator=(const JitProgram&) -> JitProgram& = delete;
+    auto operator=(JitProgram&&) -> JitProgram& = delete;
+
+    /*
+     * Executes the program on the given slot array, which must hold slots().size() values.
+     */
+    void run(Value* state) const;
+
+    [[nodiscard]] State run(const State& state) const;
+
+    [[nodiscard]] const VarSlots& slots() const { return slots_; }
+    [[nodiscard]] bool is_native() const { return fn_ != nullptr; }
+    [[nodiscard]] std::size_t code_size() const { return code_size_; }
+
+    /*
+     * Whether this build can emit and execute native code at all.
+     */
+    [[nodiscard]] static bool host_supported();
+
+private:
+    using CompiledFn = void (*)(Value*);
+
+    const Stmt* stmt_;
+    VarSlots slots_;
+    void* code_;
+    std::size_t code_size_;
+    CompiledFn fn_;
+
+    void install(const std::vector<std::uint8_t>& code);
+};
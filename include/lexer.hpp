@@ -2,27 +2,54 @@
 
 #include <vector>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <iostream>
 
 #include "token.hpp"
 
 
+/*
+ * Selects the Lexer constructor that borrows the text instead of owning a copy.
+ */
+struct borrowed_text_t {
+    explicit borrowed_text_t() = default;
+};
+inline constexpr borrowed_text_t borrowed_text{};
+
 class Lexer {
 public:
     explicit Lexer(std::string);
 
+    /*
+     * Lexes the text in place, it has to outlive tokenize (e.g. a memory-mapped ProgramSource).
+     */
+    Lexer(borrowed_text_t, std::string_view);
+
 	Lexer(const Lexer&) = delete;
 	Lexer(Lexer&&) = delete;
 	auto operator=(const Lexer&) -> Lexer& = delete;
 	auto operator=(Lexer&&) -> Lexer& = delete; 
 
     [[nodiscard]] std::vector<Token> tokenize();
+
+    /*
+     * Same as tokenize, also reports the offset in the text at which every token starts.
+     */
+    [[nodiscard]] std::vector<Token> tokenize(std::vector<std::size_t>& offsets);
+
+    /*
+     * Lexes the first token at or after offset and reports where it starts, e.g. to relex part of an edited text.
+     * Returns EndOfFile at the end of the text, lexing continues at position().
+     */
+    [[nodiscard]] Token token_at(std::size_t offset, std::size_t& start);
+    [[nodiscard]] std::size_t position() const { return position_; }
     void print_tokens(const std::vector<Token>&) const;
 
 private:
-    std::string program_text_;
-    unsigned int position_;
+    std::string owned_text_;            // Empty if the text is borrowed
+    std::string_view program_text_;
+    std::size_t position_;
 
     void advance();
     void skip_whitespace();
@@ -1,8 +1,38 @@
 #pragma once
 
+#include <memory>
+
 #include "utils.hpp"
 #include "ast.hpp"
+#include "analysis_memory.hpp"
 #include "dfa_utils.hpp"
+#include "shared_sets.hpp"
+
+class ThreadPool;
+class LVBlockSolution;
+class LVSharedSolution;
+class SummaryCache;
+class VarIndex;
+
+
+/**
+ * Fixpoint solvers of the LV-analysis, they all compute the same result.
+ */
+enum class LVSolver {
+    RoundRobin,                         // Kleene iteration of F_LV over all program points
+    ParallelRoundRobin,                 // ... with every iteration split across a thread pool
+    SCC,                                // Strongly connected components, successors first
+    ParallelSCC,                        // ... with independent components in parallel
+    WTO,                                // Recursive iteration along a weak topological order
+    Structural,                         // Gen/kill summaries composed on the AST, no iteration
+    Delta,                              // Worklist that only propagates newly added variables
+    BasicBlocks,                        // Round-robin over maximal basic blocks with composed gen/kill
+    HashConsed,                         // Round-robin on hash-consed sets with memoized union and difference
+    Indexed                             // Round-robin on sets of variable indices, dense or compressed by the variable count
+};
+
+LVSolver parse_lv_solver(const std::string& name);
+std::string lv_solver_name(LVSolver solver);
 
 
 /**
@@ -16,19 +46,58 @@
  */ 
 class LiveVariableAnalysis {
 private:
+    // gen_LV and kill_LV of a block, computed once, their union are the free variables of the block
+    struct Transfer {
+        LiveVariables gen_;
+        LiveVariables kill_;
+    };
+
     const Stmt* stmt_;                  // Statement
-    std::set<PP> pps_;                  // Program points
+    std::unique_ptr<analysis_memory::Arena> memory_;    // Containers of the analysis, declared before them
+    ProgramPoints pps_;                 // Program points
     CFG cf_;                            // Control flow
-    std::set<PP> final_pps_;            // Final program points
+    ProgramPoints final_pps_;           // Final program points
     unsigned int n_;                    // Number of program points
+    std::vector<const Block*> blocks_;  // Elementary block of program point i + 1
+    std::vector<Transfer> transfers_;   // ... and its transfer function, the solvers never look at the block itself
+    std::vector<std::vector<unsigned int>> successors_;    // Indices of the successors of program point i + 1
+    std::vector<std::vector<unsigned int>> predecessors_;  // ... and of the predecessors, both without edges leaving final points
 
 public:
     /*
      * Initialize the members using the utility functions.
      * LV-analysis needs the program points, the control flow, and the final program points.
      */
-    explicit LiveVariableAnalysis(const Stmt* stmt): stmt_{stmt}
+    explicit LiveVariableAnalysis(const Stmt* stmt):
+        stmt_{stmt}, memory_{std::make_unique<analysis_memory::Arena>()}, pps_{memory_->resource()},
+        cf_{memory_->resource()}, final_pps_{memory_->resource()}
+    {
+        // Temporaries of the checks and the program information are allocated from the arena of the analysis,
+        // the members use the same resource, so init moves the program information without copying it
+        const analysis_memory::Scope scope{memory_->resource()};
+        check_constraints(stmt);
+
+        // calculate set of pps and its size, init control-flow and final program points 
+        init(stmt);
+    }
+
+    /*
+     * Uses program information that was computed beforehand, e.g. by another pipeline stage.
+     * The program has to satisfy check_constraints already. Information from another resource is copied into the arena.
+     */
+    LiveVariableAnalysis(const Stmt* stmt, ProgramInfo info):
+        stmt_{stmt}, memory_{std::make_unique<analysis_memory::Arena>()},
+        pps_{std::move(info.pps_), memory_->resource()}, cf_{std::move(info.cf_), memory_->resource()},
+        final_pps_{std::move(info.final_pps_), memory_->resource()}, n_{static_cast<unsigned int>(pps_.size())}
     {
+        const analysis_memory::Scope scope{memory_->resource()};
+        init_tables(stmt);
+    }
+
+    /*
+     * Throws if the program is not well-formed or does not have isolated exits.
+     */
+    static void check_constraints(const Stmt* stmt) {
         // Check if program is well-formed
         if (!dfa_utils::well_formed(stmt)) throw std::runtime_error("Program is not well-formed!");
 
@@ -36,9 +105,6 @@ public:
         //  note: since unique ptrs are used its hard to add another statement without moving
         //        needs to be done manually atm
         if (!dfa_utils::has_isolated_exits(stmt)) throw std::runtime_error("Program does not have isolated exits!");
-
-        // calculate set of pps and its size, init control-flow and final program points 
-        init(stmt);
     }
 
     /*
@@ -46,16 +112,134 @@ public:
      */
     [[nodiscard]] auto compute() const -> LiveVariablesVec;
 
+    /*
+     * Same as compute, but reports the number of iterations instead of printing it.
+     * Every iteration is built in its own arena, which is released two iterations later, only the result is
+     * copied to the default resource.
+     */
+    [[nodiscard]] auto compute(unsigned int& iterations) const -> LiveVariablesVec;
+
+    /*
+     * Runs the given solver. The parallel solvers need a pool, iterations are reported as by the solver.
+     */
+    [[nodiscard]] auto compute(LVSolver solver, unsigned int& iterations, ThreadPool* pool = nullptr) const -> LiveVariablesVec;
+
     /*
      * The function F_LV that makes one analysis iteration.
-     * vec = F_LV(vec)
+     * vec = F_LV(vec), allocated from analysis_memory::resource()
      */
     [[nodiscard]] auto F_LV(const LiveVariablesVec& v) const -> LiveVariablesVec;
 
+    /*
+     * Same as compute, but every iteration updates the program points in parallel on the pool.
+     * The iteration is Jacobi-style like F_LV, so the result and the number of iterations are the same.
+     */
+    [[nodiscard]] auto compute_parallel(ThreadPool& pool, unsigned int& iterations) const -> LiveVariablesVec;
+
+    /*
+     * F_LV with the program points split into chunks across the pool.
+     * Every entry of the result only depends on v, so the chunks are independent.
+     */
+    [[nodiscard]] auto F_LV_parallel(const LiveVariablesVec& v, ThreadPool& pool) const -> LiveVariablesVec;
+
+    /*
+     * Solves the strongly connected components of the control flow one at a time, successors first.
+     * Straight-line code is evaluated once, loops iterate only locally until they are stable.
+     * Reports the largest number of passes any component needed.
+     */
+    [[nodiscard]] auto compute_scc(unsigned int& iterations) const -> LiveVariablesVec;
+
+    /*
+     * Same as compute_scc, but components whose successors are solved run in parallel on the pool.
+     */
+    [[nodiscard]] auto compute_scc_parallel(ThreadPool& pool, unsigned int& iterations) const -> LiveVariablesVec;
+
+    /*
+     * Evaluates the program points along a weak topological order of the reversed control flow, starting at
+     * the final program points. Inner loops are stabilized before outer ones and a loop is stable as soon as
+     * its head is. Reports the largest number of times a loop head was evaluated.
+     */
+    [[nodiscard]] auto compute_wto(unsigned int& iterations) const -> LiveVariablesVec;
+
+    /*
+     * Solves the equations compositionally on the AST instead of iterating: one bottom-up pass summarizes
+     * every statement as gen/kill sets, one top-down pass pushes the live variables at the exits down to the
+     * program points. Linear in the size of the program regardless of loop nesting, reports 1 iteration.
+     */
+    [[nodiscard]] auto compute_structural(unsigned int& iterations) const -> LiveVariablesVec;
+
+    /*
+     * Same as compute_structural, but the gen/kill summaries of ifs and whiles come from the cache,
+     * statements seen before are not summarized again.
+     */
+    [[nodiscard]] auto compute_structural(unsigned int& iterations, SummaryCache& cache) const -> LiveVariablesVec;
+
+    /*
+     * Semi-naive worklist solver. Every entry starts as gen, afterwards a program point only receives the
+     * variables that became live at the entries of its successors since its last visit, and passes on only
+     * those that survive its kill set and are new at its own entry. The cost of a visit is proportional to
+     * what changed, not to the size of the sets. Reports the number of visits.
+     */
+    [[nodiscard]] auto compute_delta(unsigned int& iterations) const -> LiveVariablesVec;
+
+    /*
+     * Coalesces straight-line program points into maximal basic blocks, summarizes every block as composed
+     * gen/kill sets and iterates over the blocks only, later blocks first. Only the entry and exit of every
+     * block are stored, the sets of the program points inside are reconstructed when queried.
+     * Reports the number of passes over the blocks.
+     */
+    [[nodiscard]] auto compute_basic_blocks(unsigned int& iterations) const -> LVBlockSolution;
+
+    /*
+     * Same iteration as compute, on immutable hash-consed sets (see LVSetTable): every distinct set is stored
+     * once, an iteration replaces handles instead of copying sets, union and difference are memoized and the
+     * fixpoint check compares pointers. Reports the number of iterations.
+     */
+    [[nodiscard]] auto compute_hash_consed(unsigned int& iterations) const -> LVSharedSolution;
+
+    /*
+     * Same iteration as compute, on sets of variable indices (see var_sets.hpp): one bit per variable for
+     * programs with at most dense_var_limit variables, compressed sparse sets for larger ones, where a bitset
+     * would be mostly zeros. Bitsets of up to 4 words are fixed-size and allocation-free.
+     * Reports the number of iterations.
+     */
+    [[nodiscard]] auto compute_indexed(unsigned int& iterations) const -> LiveVariablesVec;
+
+    /*
+     * The iteration of compute_indexed on the given set type, the entry and exit of program point i + 1 at
+     * 2*i and 2*i + 1. Instantiated for FixedVarSet<1>, <2> and <4>, DenseVarSet and SparseVarSet.
+     */
+    template<typename Set>
+    [[nodiscard]] auto solve_indexed(const VarIndex& index, unsigned int& iterations) const -> std::vector<Set>;
+
+    /*
+     * Variable count up to which compute_indexed uses dense bitsets, 512 bytes per set.
+     */
+    static constexpr unsigned int dense_var_limit = 4096;
+
+    /*
+     * Updates the tables after the skip or assignment at pp was replaced by replacement within program.
+     * The replacement keeps pp and numbers its other program points n + 1, n + 2, ..., edges into pp now
+     * lead to its initial program point and edges out of pp leave its final ones.
+     * Repairs the solution vec of the old program in place (see repair), returns the number of visits.
+     */
+    unsigned int replace_block(const Stmt* program, PP pp, const Stmt* replacement, LiveVariablesVec& vec);
+
+    /*
+     * Same for a new condition of the if or while at pp, the control flow stays the same.
+     */
+    unsigned int replace_condition(PP pp, const Cond* cond, LiveVariablesVec& vec);
+
     /*
      * Checks whether a fixpoint is reached, i.e. the vectors contain the same sets with the same elements.
      */
     [[nodiscard]] static bool fixpoint_reached(const LiveVariablesVec& vec_1, const LiveVariablesVec& vec_2);
+
+    /*
+     * Parallel fixpoint check, chunks stop early once any chunk found a difference.
+     */
+    [[nodiscard]] static bool fixpoint_reached_parallel(const LiveVariablesVec& vec_1, const LiveVariablesVec& vec_2,
+                                                        ThreadPool& pool);
                                                
 
     /*
@@ -65,6 +249,7 @@ public:
 
     /*
      * Generates a variable x for an elementary block iff x is read by this elementary block.
+     * Dispatches on the kind of the block, the solvers use the precomputed table instead.
      */
     [[nodiscard]] auto gen_LV(const Block* block) const -> LiveVariables;
 
@@ -74,9 +259,9 @@ public:
     [[nodiscard]] auto kill_LV(const Block* block) const -> LiveVariables;
 
     /*
-     * Prints the result to cout.
+     * Prints the result to the given stream, cout by default.
      */
-    static void print_result(const LiveVariablesVec& res);
+    static void print_result(const LiveVariablesVec& res, std::ostream& os = std::cout);
 
 private:
     /*
@@ -90,4 +275,120 @@ private:
      * Calculates and initializes all information that is needed for the LV-analysis.
      */
     void init(const Stmt* stmt);
-};
\ No newline at end of file
+
+    /*
+     * Looks up the block and the successors of every program point once, F_LV only indexes them.
+     */
+    void init_tables(const Stmt* stmt);
+
+    /*
+     * Stores block as the block of program point i + 1 together with its transfer function, after an edit.
+     */
+    void set_block(unsigned int i, const Block* block);
+
+    /*
+     * Computes the entry and exit of program points begin + 1, ..., end into vec from v.
+     */
+    void update(const LiveVariablesVec& v, LiveVariablesVec& vec, std::size_t begin, std::size_t end) const;
+
+    /*
+     * Recomputes exit and entry of program point i + 1 in place from the current entries of its successors.
+     * Returns whether the entry changed.
+     */
+    bool update_pp(std::size_t i, LiveVariablesVec& vec) const;
+
+    /*
+     * Turns the solution of the program before an edit into the solution after it, where region are the
+     * program points with new blocks, init is the one the edges into the region lead to and old_entry the
+     * former entry of the edited program point.
+     * The variables of old_entry are first deleted backwards from the predecessors of the region, as far as
+     * they are neither generated nor killed, since they may only have been live because of the old block.
+     * Facts kept this way are still derivable, so the over-deleted and re-seeded program points are
+     * re-derived with a worklist that ends in the least fixpoint again.
+     * Returns the number of visits of the worklist.
+     */
+    unsigned int repair(LiveVariablesVec& vec, const std::vector<PP>& region, PP init, const LiveVariables& old_entry) const;
+
+    /*
+     * Iterates the program points of one component until stable, returns the number of passes.
+     */
+    unsigned int solve_component(const std::vector<PP>& component, LiveVariablesVec& vec) const;
+
+    /*
+     * Recursive iteration strategy, returns the largest number of head evaluations of any component.
+     */
+    unsigned int stabilize(const WTO& order, LiveVariablesVec& vec) const;
+
+    /*
+     * Boundaries (in program points) of the parallel chunks of vec, every boundary but the first and last starts a
+     * cache line of vec. The allocation of vec need not be aligned to a line, the points before the first line
+     * boundary form a chunk of their own.
+     */
+    [[nodiscard]] std::vector<std::size_t> chunk_bounds(const LiveVariablesVec& vec, unsigned int n_threads) const;
+
+    friend class LVBlockSolution;
+};
+
+
+/**
+ * Result of LiveVariableAnalysis::compute_basic_blocks, holds the entry and exit of every basic block.
+ * The sets of a program point are computed from the exit of its block backwards through the block when queried,
+ * the last queried block is kept so walking a block point by point costs one pass over it.
+ * Refers to the analysis, which has to outlive the solution.
+ */
+class LVBlockSolution {
+private:
+    const LiveVariableAnalysis* lv_;
+    std::vector<std::vector<PP>> blocks_;   // Program points of each basic block in flow order
+    std::vector<unsigned int> block_of_;    // Block of program point i + 1
+    std::vector<unsigned int> offset_of_;   // ... and its position in the block
+    LiveVariablesVec vec_;                  // Entry and exit of block b at 2*b and 2*b + 1
+
+    mutable unsigned int cached_block_;
+    mutable LiveVariablesVec cache_;        // Entry and exit of every program point of the cached block
+
+public:
+    LVBlockSolution(const LiveVariableAnalysis& lv, std::vector<std::vector<PP>> blocks, LiveVariablesVec vec);
+
+    [[nodiscard]] auto entry(PP pp) const -> LiveVariables;
+    [[nodiscard]] auto exit(PP pp) const -> LiveVariables;
+
+    /*
+     * The entry and exit of every program point, as returned by the other solvers.
+     */
+    [[nodiscard]] auto materialize() const -> LiveVariablesVec;
+
+    [[nodiscard]] std::size_t n_blocks() const { return blocks_.size(); }
+
+private:
+    const LiveVariablesVec& reconstruct(unsigned int block) const;
+
+    /*
+     * Computes the entry and exit of every program point of the block into sets, indexed by position.
+     */
+    void expand(unsigned int block, LiveVariablesVec& sets) const;
+};
+
+/**
+ * Result of LiveVariableAnalysis::compute_hash_consed, the entry and exit of every program point as handles
+ * into the table of distinct sets it owns.
+ */
+class LVSharedSolution {
+private:
+    std::unique_ptr<LVSetTable> table_; // Declared first, the handles have to go before the table
+    std::vector<LVSet> vec_;            // Entry and exit of program point i + 1 at 2*i and 2*i + 1
+
+public:
+    LVSharedSolution(std::unique_ptr<LVSetTable> table, std::vector<LVSet> vec);
+
+    [[nodiscard]] auto entry(PP pp) const -> LiveVariables;
+    [[nodiscard]] auto exit(PP pp) const -> LiveVariables;
+
+    /*
+     * The entry and exit of every program point, as returned by the other solvers.
+     */
+    [[nodiscard]] auto materialize() const -> LiveVariablesVec;
+
+    [[nodiscard]] const std::vector<LVSet>& sets() const { return vec_; }
+    [[nodiscard]] const LVSetTable& table() const { return *table_; }
+};
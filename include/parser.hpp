@@ -4,6 +4,7 @@
 #include <utility>
 #include <vector>
 #include <stdexcept>
+#include <unordered_map>
 
 #include "ast.hpp"
 #include "token.hpp"
@@ -21,6 +22,10 @@ public:
 };
 
 
+// Range of tokens [begin, end) every statement was parsed from
+using StmtSpans = std::unordered_map<const Stmt*, std::pair<unsigned int, unsigned int>>;
+
+
 class Parser {
 public:
     explicit Parser(std::vector<Token>);
@@ -32,15 +37,32 @@ public:
 
     [[nodiscard]] std::unique_ptr<Stmt> parse();
 
+    /*
+     * Same as parse, also records the span of every statement.
+     */
+    [[nodiscard]] std::unique_ptr<Stmt> parse(StmtSpans& spans);
+
+    /*
+     * Whether all tokens were consumed, parse itself ignores trailing tokens.
+     */
+    [[nodiscard]] bool at_end() const { return position_ >= tokens_.size(); }
+
+    /*
+     * Parses a single condition [b]^pp instead of a statement, e.g. the new condition of an if or while.
+     */
+    [[nodiscard]] std::unique_ptr<Cond> parse_single_condition();
+
 private:
     std::vector<Token> tokens_;
     Token current_token_;
     unsigned int position_;
+    StmtSpans* spans_{nullptr};
 
     Token match(TokenKind token_kind);
     void consume();
 
     [[nodiscard]] PP parse_program_point();
+    void record_span(const std::unique_ptr<Stmt>& stmt, unsigned int begin);
 
     [[nodiscard]] std::unique_ptr<Stmt> parse_statement();
     [[nodiscard]] std::unique_ptr<Stmt> parse_skip_or_assign_statement();
@@ -63,6 +85,6 @@ private:
     [[nodiscard]] std::unique_ptr<BExp> parse_relational_operation();
     [[nodiscard]] std::unique_ptr<BExp> parse_boolean_operation();
     
-    [[nodiscard]] unsigned int get_idx_of_next_op() noexcept;
-    [[nodiscard]] bool is_next_binary_op_opr() noexcept;
+    [[nodiscard]] unsigned int get_idx_of_next_op();
+    [[nodiscard]] bool is_next_binary_op_opr();
 };
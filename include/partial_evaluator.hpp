@@ -0,0 +1,80 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "ast.hpp"
+#include "interpreter.hpp"
+
+
+/**
+ * Online partial evaluator that specializes a WL program to a partial initial state.
+ *
+ * Known values are propagated through the program: expressions over known variables are folded,
+ * If statements with a decidable condition are replaced by the taken branch, and While loops are
+ * unrolled as long as their condition is decidable, up to unroll_budget iterations per loop entry.
+ * Everything else is emitted into a residual program whose program points are renumbered 1..n in
+ * program order, so the result is well-formed and can be analyzed directly.
+ *
+ * Running the residual program on any completion of the partial state yields the same final state as
+ * running the original program: known variables are written back before control flow merges or loops
+ * that make them unknown, and at the end of the program.
+ */
+class PartialEvaluator {
+public:
+    explicit PartialEvaluator(State known, unsigned int unroll_budget = 64);
+
+    [[nodiscard]] std::unique_ptr<Stmt> specialize(const Stmt* stmt);
+
+    /*
+     * Specializes the program and returns the residual program as .wlang source.
+     */
+    [[nodiscard]] std::string specialize_to_wlang(const Stmt* stmt);
+
+private:
+    // Variables with a value known at specialization time, all others are dynamic
+    using Env = std::map<std::string, Value>;
+    using Residual = std::vector<std::unique_ptr<Stmt>>;
+
+    // Either a known value or a residual expression
+    struct PartialAExp {
+        std::optional<Value> known_;
+        std::unique_ptr<AExp> residual_;
+    };
+    struct PartialBExp {
+        std::optional<bool> known_;
+        std::unique_ptr<BExp> residual_;
+    };
+
+    Env env_;
+    const Env initial_env_;
+    const unsigned int unroll_budget_;
+
+    void specialize_stmt(const Stmt* stmt, Residual& out);
+    void specialize_if(const If& i, Residual& out);
+    void specialize_while(const While& w, Residual& out);
+
+    [[nodiscard]] PartialAExp specialize_aexp(const AExp* aexp) const;
+    [[nodiscard]] PartialBExp specialize_bexp(const BExp* bexp) const;
+
+    /*
+     * Emits var := value and makes the variable dynamic.
+     */
+    void materialize(const std::string& var, Residual& out);
+
+    [[nodiscard]] static std::unique_ptr<AExp> lift(PartialAExp exp);
+    [[nodiscard]] static std::unique_ptr<BExp> lift(PartialBExp exp);
+    [[nodiscard]] static std::unique_ptr<AExp> make_constant(Value value);
+    [[nodiscard]] static std::unique_ptr<Stmt> make_seq(Residual stmts);
+    [[nodiscard]] static std::set<std::string> assigned_vars(const Stmt* stmt);
+
+    /*
+     * Whether a final program point of stmt is a loop condition, i.e. stmt has no isolated exits.
+     */
+    [[nodiscard]] static bool ends_in_loop(const Stmt* stmt);
+    static void renumber(Stmt* stmt, PP& next);
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "lv.hpp"
+
+
+/**
+ * Batch analysis as a staged pipeline:
+ *  read -> tokenize -> parse -> program info (checks, CFG) -> LV -> serialize
+ *
+ * Every stage runs on its own worker threads. Stages are connected by bounded lock-free queues,
+ * a full queue stalls the producing stage (backpressure), so only a bounded number of programs is
+ * in flight no matter how many files are analyzed. Results are written in input order, reading stays at most
+ * as many programs ahead of the output as queues and workers hold, so the reorder buffer is bounded as well.
+ * Workers with nothing to do or no room to push sleep until another stage moves.
+ */
+namespace pipeline {
+    enum class Stage { Read, Tokenize, Parse, ProgramInfo, LV, Serialize };
+    constexpr std::size_t n_stages = 6;
+
+    struct Config {
+        std::array<unsigned int, n_stages> workers_{1, 1, 1, 1, 1, 1};
+        std::size_t queue_capacity_{64};          // Per queue, rounded up to a power of two
+        LVSolver solver_{LVSolver::RoundRobin};   // Sequential solvers only, programs already run in parallel
+    };
+
+    struct StageStats {
+        std::string name_;
+        unsigned int workers_;
+        std::size_t items_;
+        double busy_ms_;                          // Summed over the workers of the stage
+        // Output queue of the stage, all zero for the last stage
+        std::size_t queue_capacity_;
+        double avg_occupancy_;                    // Sampled after every push
+        std::size_t max_occupancy_;
+        std::size_t full_stalls_;                 // Pushes that found the queue full
+    };
+
+    struct Report {
+        std::size_t analyzed_;
+        std::size_t failed_;
+        double wall_ms_;
+        std::vector<StageStats> stages_;
+    };
+
+    std::string stage_name(Stage stage);
+
+    /**
+     * Analyzes all files and writes the results in the format of batch::write_results to os.
+     */
+    Report run(const std::vector<std::filesystem::path>& paths, const Config& config, std::ostream& os);
+
+    /**
+     * Prints throughput, utilization and queue occupancy of each stage.
+     */
+    void print_report(const Report& report, std::ostream& os);
+}
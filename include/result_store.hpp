@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "utils.hpp"
+
+class ProgramSource;
+
+
+/**
+ * Persistent LV results that are queried in place instead of parsing the text of print_result.
+ *
+ *  header      "SDPALV", a zero byte and a version byte, then the number of variables and of rows (u32)
+ *  dictionary  u32 offsets of the variable names into the name bytes, names sorted like LiveVariables
+ *  rows        u32 offsets of the rows, then the rows: vec[2 * (pp - 1)] is the entry of pp and
+ *              vec[2 * (pp - 1) + 1] its exit, as in LiveVariablesVec
+ *
+ * A row is a tag byte and either a bitset over the dictionary, the alternating lengths of absent and present
+ * runs of variables as varints, whichever is shorter, or the index of an earlier row with the same variables.
+ * Entry and exit of neighbouring program points mostly coincide, so most rows are such references.
+ * Integers are in host byte order, the offsets make every row addressable without decoding the others.
+ */
+class LVResultStore {
+public:
+    /*
+     * Maps the file, throws if it is not a result store of this version.
+     */
+    explicit LVResultStore(const std::filesystem::path& path);
+    ~LVResultStore();
+
+    LVResultStore(const LVResultStore&) = delete;
+    LVResultStore(LVResultStore&&) = delete;
+    auto operator=(const LVResultStore&) -> LVResultStore& = delete;
+    auto operator=(LVResultStore&&) -> LVResultStore& = delete;
+
+    [[nodiscard]] unsigned int n_pps() const { return n_rows_ / 2; }
+    [[nodiscard]] const std::vector<std::string_view>& variables() const { return variables_; }
+
+    /*
+     * Indices into variables of the live variables at the entry / exit of pp, in ascending order.
+     */
+    [[nodiscard]] std::vector<unsigned int> entry(PP pp) const;
+    [[nodiscard]] std::vector<unsigned int> exit(PP pp) const;
+
+    [[nodiscard]] bool live_at_entry(PP pp, std::string_view var) const;
+    [[nodiscard]] bool live_at_exit(PP pp, std::string_view var) const;
+
+    /*
+     * All rows as a LiveVariablesVec, the variables point into the store.
+     */
+    [[nodiscard]] LiveVariablesVec materialize() const;
+
+    [[nodiscard]] static std::string encode(const LiveVariablesVec& vec);
+    static void write(const LiveVariablesVec& vec, const std::filesystem::path& path);
+
+private:
+    std::unique_ptr<ProgramSource> source_;
+    std::string_view data_;
+    unsigned int n_rows_;
+    std::vector<std::string_view> variables_;
+    std::vector<Var> vars_;             // Backing the sets of materialize
+    std::size_t row_offsets_;           // Position of the row offset table
+    std::size_t rows_;                  // ... and of the first row
+
+    [[nodiscard]] std::vector<unsigned int> row(unsigned int i) const;
+    [[nodiscard]] bool contains(unsigned int i, std::string_view var) const;
+
+    /*
+     * Calls visit with the variable indices of row i from index from on in ascending order, until it returns false.
+     * Decodes in place, bitset rows start at from directly.
+     */
+    template<typename Visit>
+    void scan(unsigned int i, Visit visit, unsigned int from = 0) const;
+    [[nodiscard]] std::uint32_t u32(std::size_t pos) const;
+};
@@ -3,17 +3,29 @@
 #include "utils.hpp"
 
 
-std::set<PP> pp_set_intersect(const std::set<PP>& set1, const std::set<PP>& set2);
+ProgramPoints pp_set_intersect(const ProgramPoints& set1, const ProgramPoints& set2);
+
+/*
+ * The results are allocated from analysis_memory::resource().
+ */
 
 /**
  * Calculates set1 \ set2, i.e. all values in set1 that are not in set2
  */
 auto var_ptr_set_difference(
-    const std::set<const Var*, VarPtrCmp>& set1,
-    const std::set<const Var*, VarPtrCmp>& set2
-) -> std::set<const Var*, VarPtrCmp>;
+    const std::pmr::set<const Var*, VarPtrCmp>& set1,
+    const std::pmr::set<const Var*, VarPtrCmp>& set2
+) -> std::pmr::set<const Var*, VarPtrCmp>;
+
+/**
+ * Calculates set1 ∩ set2 by variable name, the elements are taken from set1
+ */
+auto var_ptr_set_intersection(
+    const std::pmr::set<const Var*, VarPtrCmp>& set1,
+    const std::pmr::set<const Var*, VarPtrCmp>& set2
+) -> std::pmr::set<const Var*, VarPtrCmp>;
 
 bool var_ptr_set_equality(
-    const std::set<const Var*, VarPtrCmp>& set1,
-    const std::set<const Var*, VarPtrCmp>& set2
+    const std::pmr::set<const Var*, VarPtrCmp>& set1,
+    const std::pmr::set<const Var*, VarPtrCmp>& set2
 );
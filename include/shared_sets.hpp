@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "utils.hpp"
+
+class LVSetTable;
+
+
+/**
+ * Handle to an immutable live variable set in an LVSetTable. Equal sets share one canonical node, so
+ * comparing two handles compares pointers. The default handle is the empty set.
+ * Handles are reference counted (not thread safe) and must not outlive their table.
+ */
+class LVSet {
+public:
+    LVSet() = default;
+    LVSet(const LVSet& other);
+    LVSet(LVSet&& other) noexcept;
+    auto operator=(const LVSet& other) -> LVSet&;
+    auto operator=(LVSet&& other) noexcept -> LVSet&;
+    ~LVSet();
+
+    bool operator==(const LVSet& other) const { return node_ == other.node_; }
+
+    [[nodiscard]] bool empty() const { return !node_; }
+    [[nodiscard]] std::size_t size() const;
+
+    /*
+     * The variables in the order of LiveVariables.
+     */
+    [[nodiscard]] const std::vector<const Var*>& vars() const;
+    [[nodiscard]] LiveVariables to_set() const;
+
+private:
+    friend class LVSetTable;
+
+    struct Node {
+        std::vector<const Var*> vars_;
+        std::size_t hash_;
+        std::uint64_t id_;                  // Never reused, keys the memo tables
+        unsigned int refs_;
+        LVSetTable* table_;
+    };
+
+    // Takes a new reference to node
+    explicit LVSet(Node* node);
+
+    Node* node_{nullptr};
+};
+
+
+/**
+ * Unique table of hash-consed live variable sets. Every distinct set is stored once, a set is freed when its
+ * last handle goes away. Union and difference are memoized on the pair of operands, repeating an operation on
+ * the same sets is a lookup. Variables are canonicalized by name, sets from different programs or analyses
+ * with equal names share nodes.
+ */
+class LVSetTable {
+public:
+    LVSetTable() = default;
+    ~LVSetTable();
+
+    LVSetTable(const LVSetTable&) = delete;
+    LVSetTable(LVSetTable&&) = delete;
+    auto operator=(const LVSetTable&) -> LVSetTable& = delete;
+    auto operator=(LVSetTable&&) -> LVSetTable& = delete;
+
+    LVSet make(const LiveVariables& vars);
+
+    LVSet unite(const LVSet& lhs, const LVSet& rhs);
+    LVSet difference(const LVSet& lhs, const LVSet& rhs);
+
+    /*
+     * Drops the memoized results, the sets only they kept alive are freed.
+     */
+    void clear_memo();
+
+    // Distinct non-empty sets and their summed sizes
+    [[nodiscard]] std::size_t size() const { return size_; }
+    [[nodiscard]] std::size_t stored_elements() const { return stored_elements_; }
+    [[nodiscard]] std::size_t memo_hits() const { return memo_hits_; }
+
+private:
+    friend class LVSet;
+
+    struct PairHash {
+        std::size_t operator()(const std::pair<std::uint64_t, std::uint64_t>& key) const {
+            return std::hash<std::uint64_t>{}(key.first * 0x9e3779b97f4a7c15ull ^ key.second);
+        }
+    };
+    using Memo = std::unordered_map<std::pair<std::uint64_t, std::uint64_t>, LVSet, PairHash>;
+
+    std::unordered_map<std::size_t, std::vector<LVSet::Node*>> unique_;  // Nodes by the hash of their variables
+    std::unordered_map<std::string_view, const Var*> canonical_;       // First variable seen with a name
+    Memo unions_;
+    Memo differences_;
+    std::uint64_t next_id_{0};
+    std::size_t size_{0};
+    std::size_t stored_elements_{0};
+    std::size_t memo_hits_{0};
+
+    /*
+     * The handle of the set with the given canonical variables, sorted by name.
+     */
+    LVSet intern(std::vector<const Var*> vars);
+    void release(LVSet::Node* node);
+};
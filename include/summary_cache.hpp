@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ast.hpp"
+#include "ast_hash.hpp"
+#include "utils.hpp"
+
+
+/**
+ * Cache of analysis summaries of if and while statements, keyed by their structural hash (see ast_hash), that
+ * can be kept on disk and shared by many runs and programs.
+ *
+ * A summary does not depend on the numbering of the statement: its program points are numbered 0, 1, ... in
+ * the order of the program text, the control flow, initial and final program points refer to these indices and
+ * the LV transfer function is stored as gen/kill sets of variable names. A program that contains a statement
+ * seen before, in the same or in another program, maps the stored summary onto its own program points instead
+ * of recomputing it. Skips, assignments and sequences are cheap to summarize and not stored.
+ *
+ * The cache is safe to use from several threads. The file format is binary in host byte order, a file that
+ * cannot be read (missing, other version, truncated) is ignored and the cache starts empty.
+ */
+class SummaryCache {
+public:
+    struct Entry {
+        unsigned int n_pps_{0};                                     // Program points, indexed 0 to n - 1
+        std::vector<std::pair<unsigned int, unsigned int>> flow_;   // Control flow between indices
+        unsigned int initial_{0};
+        std::vector<unsigned int> finals_;
+        std::set<std::string> gen_;                                 // LV transfer function from exit to entry
+        std::set<std::string> kill_;
+    };
+
+    using Summaries = std::unordered_map<const Stmt*, const Entry*>;
+
+    // In memory only, save does nothing
+    SummaryCache() = default;
+
+    /*
+     * Loads the cache from path if it exists, save writes it back there.
+     */
+    explicit SummaryCache(std::filesystem::path path);
+
+    SummaryCache(const SummaryCache&) = delete;
+    auto operator=(const SummaryCache&) -> SummaryCache& = delete;
+
+    /*
+     * Program points, control flow and final program points like dfa_utils::program_info, composed from the
+     * summaries of the statements of the program.
+     */
+    ProgramInfo program_info(const Stmt* stmt);
+
+    /*
+     * Summary of every if and while statement within stmt, looked up or computed and stored.
+     * The entries stay valid as long as the cache.
+     */
+    Summaries summaries(const Stmt* stmt);
+
+    /*
+     * Writes the cache atomically to its file, replacing what was there.
+     */
+    void save() const;
+
+    [[nodiscard]] std::size_t size() const;
+    [[nodiscard]] std::size_t hits() const;
+    [[nodiscard]] std::size_t misses() const;
+
+    /*
+     * summaries.bin in the cache directory of the C backend.
+     */
+    [[nodiscard]] static std::filesystem::path default_path();
+
+private:
+    std::filesystem::path path_;
+    mutable std::mutex mutex_;
+    std::unordered_map<ast_hash::Hash, Entry> entries_;
+    std::size_t hits_{0};
+    std::size_t misses_{0};
+
+    /*
+     * Summary of an if or while statement.
+     */
+    const Entry& lookup(const Stmt* stmt, const ast_hash::StmtHashes& hashes);
+
+    /*
+     * Summary of any statement, sequences are composed from the summaries of their elements.
+     */
+    Entry summarize(const Stmt* stmt, const ast_hash::StmtHashes& hashes);
+
+    void load();
+};
@@ -1,6 +1,15 @@
 #pragma once
 
+#include <sstream>
+
 #include "dfa_utils.hpp"
+#include "ast_binary.hpp"
+#include "ast_hash.hpp"
+#include "ast_printer.hpp"
+#include "lexer.hpp"
+#include "lv.hpp"
+#include "parser.hpp"
+#include "partial_evaluator.hpp"
 
 
 void testing_dfa_utils(const Stmt* stmt)
@@ -28,3 +37,39 @@ void testing_dfa_utils(const Stmt* stmt)
     std::cout << (ientries ? "isolated entries" : "no isolated entries") << "\n";
     std::cout << (iexits ? "isolated exits" : "no isolated exits") << "\n";
 }
+
+void testing_ast_binary(const Stmt* stmt)
+{
+    const auto data = ast_binary::write(stmt);
+    const auto read = ast_binary::read(data);
+
+    // The structural hash covers the nesting of sequences, the printed source the program points
+    std::stringstream expected{}, result{};
+    ASTSourcePrinter{expected}.print(*stmt);
+    ASTSourcePrinter{result}.print(*read);
+    const bool equal = ast_hash::hash_stmt(stmt) == ast_hash::hash_stmt(read.get()) && expected.str() == result.str();
+
+    std::cout << "Binary AST: " << data.size() << " bytes, round trip " << (equal ? "ok" : "failed") << "\n";
+}
+
+void testing_partial_evaluator()
+{
+    // Residual programs have to stay analyzable, here the trailing skip is the only isolated exit
+    const std::string source{"while [(x > 1)]^1 do [x := (x - 1)]^2 od; [skip]^3"};
+    Lexer lexer{source};
+    Parser parser{lexer.tokenize()};
+    const auto stmt = parser.parse();
+
+    PartialEvaluator evaluator{{}};
+    const auto residual = evaluator.specialize(stmt.get());
+
+    bool analyzable = dfa_utils::well_formed(residual.get()) && dfa_utils::has_isolated_exits(residual.get());
+    try {
+        LiveVariableAnalysis lv{residual.get()};
+        static_cast<void>(lv.compute());
+    } catch (const std::exception&) {
+        analyzable = false;
+    }
+
+    std::cout << "Partial evaluation: residual program " << (analyzable ? "analyzable" : "not analyzable") << "\n";
+}
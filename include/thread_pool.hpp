@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/**
+ * Fixed-size work-stealing thread pool.
+ *
+ * Every worker owns a deque of tasks. Workers take tasks from the back of their own deque and,
+ * when it runs dry, steal from the front of the others. Tasks submitted from inside a worker go to
+ * that worker's deque, tasks submitted from outside are distributed round-robin.
+ */
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit ThreadPool(unsigned int n_threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool(ThreadPool&&) = delete;
+    auto operator=(const ThreadPool&) -> ThreadPool& = delete;
+    auto operator=(ThreadPool&&) -> ThreadPool& = delete;
+
+    void submit(Task task);
+
+    /*
+     * Blocks until every submitted task has finished.
+     * Rethrows the first exception that escaped a task, if any.
+     */
+    void wait();
+
+    /*
+     * Splits [0, n) into chunks of grain elements, runs body(begin, end) for every chunk and waits.
+     * Must not be called from a task of the same pool.
+     */
+    void parallel_for(std::size_t n, std::size_t grain, const std::function<void(std::size_t, std::size_t)>& body);
+
+    [[nodiscard]] unsigned int size() const { return threads_.size(); }
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex_;
+        std::deque<Task> tasks_;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::vector<std::thread> threads_;
+    std::atomic<unsigned int> next_queue_;
+
+    std::mutex mutex_;                  // Guards the counters below
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    std::size_t queued_;                // Tasks waiting in some deque
+    std::size_t pending_;               // Tasks submitted but not yet finished
+    bool stop_;
+    std::exception_ptr error_;
+
+    void worker_loop(unsigned int idx);
+    bool try_pop(unsigned int idx, Task& task);
+    bool try_steal(unsigned int idx, Task& task);
+};
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory_resource>
 #include <vector>
 #include <set>
 #include <unordered_set>
@@ -27,11 +28,30 @@ struct VarPtrCmp {
 };
 
 
-// Types for readability
-using FreeVariables = std::set<const Var*, VarPtrCmp>;
-using ElementaryBlocks = std::set<const Block*, BlockPtrCmp>;
+// Types for readability, allocated from analysis_memory::resource() by the analyses (see analysis_memory.hpp)
+using FreeVariables = std::pmr::set<const Var*, VarPtrCmp>;
+using ElementaryBlocks = std::pmr::set<const Block*, BlockPtrCmp>;
+using ProgramPoints = std::pmr::set<PP>;
 using ControlFlowEdge = std::pair<PP, PP>;
-using CFG = std::set<ControlFlowEdge>;
-using LiveVariables = std::set<const Var*, VarPtrCmp>;
-using LiveVariablesVec = std::vector<LiveVariables>;
+using CFG = std::pmr::set<ControlFlowEdge>;
+using LiveVariables = std::pmr::set<const Var*, VarPtrCmp>;
+using LiveVariablesVec = std::pmr::vector<LiveVariables>;
+
+
+// Weak topological order (Bourdoncle): a sequence of program points and components,
+// a component is a head followed by a nested order of the rest of the loop
+struct WTOElement {
+    PP pp_;                             // Program point, or head of the component
+    std::vector<WTOElement> component_; // Empty for plain program points
+    bool is_component_;
+};
+using WTO = std::vector<WTOElement>;
+
+
+// Everything the analyses need to know about a program besides the AST itself
+struct ProgramInfo {
+    ProgramPoints pps_;                 // Program points
+    CFG cf_;                            // Control flow
+    ProgramPoints final_pps_;           // Final program points
+};
 
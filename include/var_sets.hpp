@@ -0,0 +1,201 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "utils.hpp"
+
+
+/**
+ * Dense numbering of the variables of a program. Indices ascend with the names, so a set of indices visited in
+ * ascending order yields the variables in the order of LiveVariables.
+ */
+class VarIndex {
+public:
+    explicit VarIndex(const FreeVariables& vars);
+
+    [[nodiscard]] unsigned int size() const { return static_cast<unsigned int>(vars_.size()); }
+
+    /*
+     * Index of the variable with the name of var, throws if the program does not have it.
+     */
+    [[nodiscard]] unsigned int index(const Var* var) const;
+    [[nodiscard]] const Var* var(unsigned int index) const { return vars_[index]; }
+
+    /*
+     * Converts between LiveVariables and any of the index sets below.
+     */
+    template<typename Set>
+    [[nodiscard]] Set make(const LiveVariables& vars) const {
+        Set set{size()};
+        for (const auto* var: vars) set.insert(index(var));
+        return set;
+    }
+
+    template<typename Set>
+    [[nodiscard]] LiveVariables to_set(const Set& set) const {
+        LiveVariables vars{};
+        set.for_each([this, &vars](unsigned int i) { vars.insert(vars.end(), vars_[i]); });
+        return vars;
+    }
+
+private:
+    std::vector<const Var*> vars_;
+    std::unordered_map<std::string_view, unsigned int> indices_;
+};
+
+
+/**
+ * Set of variable indices as one bit per variable of the program. Every set has the size of the whole program,
+ * union and difference are word operations.
+ */
+class DenseVarSet {
+public:
+    explicit DenseVarSet(unsigned int n_vars = 0): words_((n_vars + 63) / 64) {}
+
+    void insert(unsigned int i) { words_[i / 64] |= std::uint64_t{1} << (i % 64); }
+    [[nodiscard]] bool contains(unsigned int i) const { return words_[i / 64] >> (i % 64) & 1; }
+    void clear() { std::fill(words_.begin(), words_.end(), 0); }
+
+    void unite(const DenseVarSet& other) {
+        for (std::size_t w = 0; w < words_.size(); ++w) words_[w] |= other.words_[w];
+    }
+    void subtract(const DenseVarSet& other) {
+        for (std::size_t w = 0; w < words_.size(); ++w) words_[w] &= ~other.words_[w];
+    }
+
+    bool operator==(const DenseVarSet& other) const = default;
+
+    [[nodiscard]] std::size_t size() const {
+        std::size_t n = 0;
+        for (const auto word: words_) n += std::popcount(word);
+        return n;
+    }
+
+    template<typename Visit>
+    void for_each(Visit visit) const {
+        for (std::size_t w = 0; w < words_.size(); ++w) {
+            for (auto word = words_[w]; word; word &= word - 1) visit(static_cast<unsigned int>(w * 64 + std::countr_zero(word)));
+        }
+    }
+
+    [[nodiscard]] std::size_t bytes() const { return words_.size() * sizeof(std::uint64_t); }
+
+private:
+    std::vector<std::uint64_t> words_;
+};
+
+
+
+/**
+ * DenseVarSet for programs with at most 64 * Words variables. The words are part of the object, a vector of sets
+ * is one contiguous array and no operation allocates. Union and difference compile to Words ALU operations each.
+ */
+template<std::size_t Words>
+class FixedVarSet {
+public:
+    static constexpr unsigned int max_vars = 64 * Words;
+
+    explicit FixedVarSet(unsigned int /*n_vars*/ = 0) {}
+
+    void insert(unsigned int i) { words_[i / 64] |= std::uint64_t{1} << (i % 64); }
+    [[nodiscard]] bool contains(unsigned int i) const { return words_[i / 64] >> (i % 64) & 1; }
+    void clear() { words_ = {}; }
+
+    void unite(const FixedVarSet& other) {
+        for (std::size_t w = 0; w < Words; ++w) words_[w] |= other.words_[w];
+    }
+    void subtract(const FixedVarSet& other) {
+        for (std::size_t w = 0; w < Words; ++w) words_[w] &= ~other.words_[w];
+    }
+
+    bool operator==(const FixedVarSet& other) const = default;
+
+    [[nodiscard]] std::size_t size() const {
+        std::size_t n = 0;
+        for (const auto word: words_) n += std::popcount(word);
+        return n;
+    }
+
+    template<typename Visit>
+    void for_each(Visit visit) const {
+        for (std::size_t w = 0; w < Words; ++w) {
+            for (auto word = words_[w]; word; word &= word - 1) visit(static_cast<unsigned int>(w * 64 + std::countr_zero(word)));
+        }
+    }
+
+    // Nothing outside the object
+    [[nodiscard]] std::size_t bytes() const { return 0; }
+
+private:
+    std::array<std::uint64_t, Words> words_{};
+};
+
+/**
+ * Set of variable indices for programs with many variables of which few are live at a time (roaring bitmap).
+ * Indices are grouped into chunks of 2^16 by their upper bits. Only chunks with elements are stored, each as the
+ * sorted lower bits while it has at most 4096 elements and as a bitmap of 2^16 bits beyond that, so a set never
+ * takes more than about two bytes per element. The representation of a set is unique, equality compares it directly.
+ */
+class SparseVarSet {
+public:
+    explicit SparseVarSet(unsigned int /*n_vars*/ = 0) {}
+
+    void insert(unsigned int i);
+    [[nodiscard]] bool contains(unsigned int i) const;
+    void clear() { chunks_.clear(); }
+
+    void unite(const SparseVarSet& other);
+    void subtract(const SparseVarSet& other);
+
+    bool operator==(const SparseVarSet& other) const = default;
+
+    [[nodiscard]] std::size_t size() const;
+
+    template<typename Visit>
+    void for_each(Visit visit) const {
+        for (const auto& chunk: chunks_) {
+            const unsigned int base = static_cast<unsigned int>(chunk.key_) << 16;
+            if (chunk.bitmap_.empty()) {
+                for (const auto low: chunk.array_) visit(base | low);
+                continue;
+            }
+            for (std::size_t w = 0; w < chunk.bitmap_.size(); ++w) {
+                for (auto word = chunk.bitmap_[w]; word; word &= word - 1) {
+                    visit(base | static_cast<unsigned int>(w * 64 + std::countr_zero(word)));
+                }
+            }
+        }
+    }
+
+    [[nodiscard]] std::size_t bytes() const;
+
+private:
+    static constexpr std::size_t max_array = 4096;      // Beyond this a bitmap is smaller than the array
+    static constexpr std::size_t bitmap_words = 1024;
+
+    struct Chunk {
+        std::uint16_t key_;                 // Upper 16 bits of the indices
+        std::uint32_t size_;
+        std::vector<std::uint16_t> array_;  // Lower 16 bits, sorted, while size_ <= max_array
+        std::vector<std::uint64_t> bitmap_; // ... or bitmap_words words otherwise
+
+        bool operator==(const Chunk& other) const = default;
+    };
+    std::vector<Chunk> chunks_;             // Non-empty chunks sorted by key
+
+    static void unite(Chunk& chunk, const Chunk& other);
+    void merge(const SparseVarSet& other);      // unite where other has chunks this set does not
+    static void subtract(Chunk& chunk, const Chunk& other);
+
+    /*
+     * Switches between array and bitmap after the size of the chunk changed.
+     */
+    static void normalize(Chunk& chunk);
+};
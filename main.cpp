@@ -1,4 +1,10 @@
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <memory>
+#include <algorithm>
 
 #include "lexer.hpp"
 #include "parser.hpp"
@@ -8,13 +14,36 @@
 #include "ast_printer.hpp"
 #include "lv.hpp"
 #include "test.hpp"
+#include "bench.hpp"
+#include "batch.hpp"
+#include "pipeline.hpp"
+#include "summary_cache.hpp"
+#include "result_store.hpp"
+#include "thread_pool.hpp"
 
 
-void run(char *argv[]) {
-    const WLangReader reader{argv, "./resources/factorial.wlang"};
-    const auto program_text = reader.read_program();
+/*
+ * sdpa [program.wlang | -] [--store FILE] [--solver NAME] [--jobs N]
+ * Absolute paths and stdin (-) are taken as is, relative paths are resolved against the project directory.
+ * With --store, the result is also written to FILE as an LV result store.
+ * The parallel solvers run on a pool of N threads (all hardware threads by default).
+ */
+void run(int argc, char *argv[]) {
+    std::string store{};
+    LVSolver solver = LVSolver::RoundRobin;
+    unsigned int jobs = std::thread::hardware_concurrency();
 
-    Lexer lexer { program_text };
+    for (int i = 2; i + 1 < argc; i += 2) {
+        const std::string flag{argv[i]};
+        if (flag == "--store") store = argv[i + 1];
+        else if (flag == "--solver") solver = parse_lv_solver(argv[i + 1]);
+        else if (flag == "--jobs") jobs = std::stoul(argv[i + 1]);
+    }
+
+    const WLangReader reader{argv, argc > 1 ? argv[1] : "./resources/factorial.wlang"};
+    const auto source = reader.map_program();
+
+    Lexer lexer { borrowed_text, source->text() };
     const auto tokens = lexer.tokenize();
     //lexer.print_tokens( tokens );
 
@@ -22,17 +51,145 @@ void run(char *argv[]) {
     const auto stmt = parser.parse();
 
     testing_dfa_utils(stmt.get());
+    testing_partial_evaluator();
+    testing_ast_binary(stmt.get());
 
     //ASTPrinter printer{};
     //printer.print_AST(*stmt);
 
+    //benchmark_jit(stmt.get());
+    //benchmark_closures(stmt.get());
+    //benchmark_batch(stmt.get());
+    //benchmark_c_backend(stmt.get());
+    //benchmark_partial_evaluation(stmt.get(), {{"x", 10}});
+    //benchmark_parallel_lv(stmt.get());
+    //benchmark_lv_solvers(stmt.get());
+    //benchmark_incremental_lv(std::string{source->text()});
+    //benchmark_incremental_parsing(std::string{source->text()});
+    //benchmark_summary_cache(stmt.get());
+    //benchmark_ast_loading(std::string{source->text()});
+    //benchmark_result_store(stmt.get());
+    //benchmark_hash_consed_lv(stmt.get());
+    //benchmark_indexed_lv(stmt.get());
+    //benchmark_analysis_memory(stmt.get());
+
+    // Only the parallel solvers need the pool
+    std::unique_ptr<ThreadPool> pool{};
+    if (solver == LVSolver::ParallelRoundRobin || solver == LVSolver::ParallelSCC) {
+        pool = std::make_unique<ThreadPool>(std::max(jobs, 1u));
+    }
+
     LiveVariableAnalysis lv { stmt.get() };
-    auto lvs = lv.compute();
+    unsigned int iterations = 0;
+    auto lvs = lv.compute(solver, iterations, pool.get());
+
+    std::cout << "LV-analysis in " << iterations << " iterations.\n";
     LiveVariableAnalysis::print_result(lvs);
+
+    if (!store.empty()) LVResultStore::write(lvs, store);
+}
+
+/*
+ * sdpa --batch <directory|file list> [--jobs N] [--output FILE] [--solver round-robin|scc|wto] [--summaries FILE]
+ * With --summaries, analysis summaries are loaded from and saved to FILE ("default" for the cache directory).
+ */
+int run_batch(int argc, char *argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " --batch <directory|file list> [--jobs N] [--output FILE] [--solver NAME] [--summaries FILE]\n";
+        return 2;
+    }
+
+    const std::filesystem::path input{argv[2]};
+    unsigned int jobs = std::thread::hardware_concurrency();
+    std::string output = "sdpa_results.txt";
+    LVSolver solver = LVSolver::RoundRobin;
+    std::unique_ptr<SummaryCache> summaries{};
+
+    for (int i = 3; i + 1 < argc; i += 2) {
+        const std::string flag{argv[i]};
+        if (flag == "--jobs") jobs = std::stoul(argv[i + 1]);
+        else if (flag == "--output") output = argv[i + 1];
+        else if (flag == "--solver") solver = parse_lv_solver(argv[i + 1]);
+        else if (flag == "--summaries") {
+            const std::filesystem::path path{argv[i + 1]};
+            summaries = std::make_unique<SummaryCache>(path == "default" ? SummaryCache::default_path() : path);
+        }
+        else {
+            std::cerr << "Unknown option " << flag << "\n";
+            return 2;
+        }
+    }
+
+    const auto paths = batch::collect_inputs(input);
+    const auto results = batch::run(paths, jobs, solver, summaries.get());
+    if (summaries) summaries->save();
+
+    std::ofstream out{output};
+    batch::write_results(results, out);
+
+    const auto failed = std::count_if(results.begin(), results.end(), [](const auto& r) { return !r.ok_; });
+    std::cout << "Analyzed " << results.size() << " programs (" << failed << " failed), results in " << output << "\n";
+
+    return failed == 0 ? 0 : 1;
+}
+
+/*
+ * sdpa --pipeline <directory|file list> [--workers R,T,P,I,L,S] [--queue N] [--output FILE] [--solver NAME]
+ * Worker counts are given per stage: read, tokenize, parse, program info, lv, serialize.
+ */
+int run_pipeline(int argc, char *argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0]
+                  << " --pipeline <directory|file list> [--workers R,T,P,I,L,S] [--queue N] [--output FILE] [--solver NAME]\n";
+        return 2;
+    }
+
+    const std::filesystem::path input{argv[2]};
+    pipeline::Config config{};
+    std::string output = "sdpa_results.txt";
+
+    for (int i = 3; i + 1 < argc; i += 2) {
+        const std::string flag{argv[i]};
+        if (flag == "--workers") {
+            std::stringstream counts{argv[i + 1]};
+            std::string count{};
+            for (std::size_t s = 0; s < pipeline::n_stages && std::getline(counts, count, ','); ++s) {
+                config.workers_[s] = std::stoul(count);
+            }
+        }
+        else if (flag == "--queue") config.queue_capacity_ = std::stoul(argv[i + 1]);
+        else if (flag == "--solver") config.solver_ = parse_lv_solver(argv[i + 1]);
+        else if (flag == "--output") output = argv[i + 1];
+        else {
+            std::cerr << "Unknown option " << flag << "\n";
+            return 2;
+        }
+    }
+
+    const auto paths = batch::collect_inputs(input);
+
+    std::ofstream out{output};
+    const auto report = pipeline::run(paths, config, out);
+    pipeline::print_report(report, std::cout);
+    std::cout << "Results in " << output << "\n";
+
+    return report.failed_ == 0 ? 0 : 1;
 }
 
 int main(int argc, char *argv[]) {
-    run(argv);
+    try {
+        if (argc > 1 && std::string(argv[1]) == "--batch") {
+            return run_batch(argc, argv);
+        }
+        if (argc > 1 && std::string(argv[1]) == "--pipeline") {
+            return run_pipeline(argc, argv);
+        }
+        run(argc, argv);
+    } catch (const std::invalid_argument& e) {
+        // Malformed options, e.g. unknown solvers or non-numeric counts
+        std::cerr << e.what() << "\n";
+        return 2;
+    }
 
     return 0;
 }
@@ -0,0 +1,47 @@
+#include "analysis_memory.hpp"
+
+#if __has_include(<sys/resource.h>)
+#define SDPA_RUSAGE 1
+#include <sys/resource.h>
+#endif
+
+
+namespace {
+    thread_local std::pmr::memory_resource* current = nullptr;
+}
+
+std::pmr::memory_resource* analysis_memory::resource() {
+    return current ? current : std::pmr::get_default_resource();
+}
+
+analysis_memory::Scope::Scope(std::pmr::memory_resource* resource): previous_{current} {
+    current = resource;
+}
+
+analysis_memory::Scope::~Scope() {
+    current = previous_;
+}
+
+void* analysis_memory::CountingResource::do_allocate(std::size_t bytes, std::size_t alignment) {
+    ++allocations_;
+    bytes_ += bytes;
+    return upstream_->allocate(bytes, alignment);
+}
+
+void analysis_memory::CountingResource::do_deallocate(void* p, std::size_t bytes, std::size_t alignment) {
+    upstream_->deallocate(p, bytes, alignment);
+}
+
+bool analysis_memory::CountingResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+std::size_t analysis_memory::peak_rss_kb() {
+#ifdef SDPA_RUSAGE
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    return static_cast<std::size_t>(usage.ru_maxrss);
+#else
+    return 0;
+#endif
+}
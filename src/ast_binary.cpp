@@ -0,0 +1,395 @@
+#include "ast_binary.hpp"
+
+#include <array>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "io.hpp"
+#include "utils.hpp"
+
+
+namespace {
+    constexpr std::string_view file_magic = "SDPAAST";
+
+    enum class Tag: std::uint8_t {
+        Skip, Assign, If, While, Seq,
+        Var, Num, ArithmeticOp,
+        True, False, Not, BooleanOp, RelationalOp
+    };
+
+    // Every spelling the lexer produces, the index is the operator code
+    constexpr std::array<std::string_view, 11> operators{
+        "+", "-", "*",
+        "<", "<=", ">", ">=",
+        "and", "&&", "or", "||"
+    };
+
+    class Writer {
+    public:
+        std::string names_;
+        std::string nodes_;
+
+        void stmt(const Stmt* stmt) {
+            // Sequences along the right spine in one node, so long programs need no deep recursion
+            std::vector<const Stmt*> elements{};
+            while (const auto* sc = std::get_if<SeqComp>(stmt)) {
+                elements.push_back(sc->fst_.get());
+                stmt = sc->snd_.get();
+            }
+            if (!elements.empty()) {
+                elements.push_back(stmt);
+                tag(Tag::Seq);
+                varint(elements.size());
+                for (const auto* element: elements) this->stmt(element);
+                return;
+            }
+
+            auto visitor = overload {
+                [this](const Skip& s) {
+                    tag(Tag::Skip);
+                    pp(s.pp_);
+                },
+                [this](const Assign& a) {
+                    tag(Tag::Assign);
+                    pp(a.pp_);
+                    varint(name(a.var_->name_));
+                    aexp(a.aexp_.get());
+                },
+                [this](const If& i) {
+                    tag(Tag::If);
+                    pp(i.cond_->pp_);
+                    bexp(i.cond_->bexp_.get());
+                    this->stmt(i.then_.get());
+                    this->stmt(i.else_.get());
+                },
+                [this](const While& w) {
+                    tag(Tag::While);
+                    pp(w.cond_->pp_);
+                    bexp(w.cond_->bexp_.get());
+                    this->stmt(w.body_.get());
+                },
+                [](const SeqComp& sc) {}
+            };
+
+            std::visit(visitor, *stmt);
+        }
+
+        std::uint64_t n_names() const { return indices_.size(); }
+
+    private:
+        std::unordered_map<std::string, std::uint64_t> indices_;
+        PP last_pp_{0};
+
+        void aexp(const AExp* aexp) {
+            auto visitor = overload {
+                [this](const Var& v) {
+                    tag(Tag::Var);
+                    varint(name(v.name_));
+                },
+                [this](const Num& n) {
+                    tag(Tag::Num);
+                    varint(n.val_);
+                },
+                [this](const ArithmeticOp& op) {
+                    tag(Tag::ArithmeticOp);
+                    varint(operator_code(op.op_));
+                    this->aexp(op.lhs_.get());
+                    this->aexp(op.rhs_.get());
+                }
+            };
+
+            std::visit(visitor, *aexp);
+        }
+
+        void bexp(const BExp* bexp) {
+            auto visitor = overload {
+                [this](const True& t) {
+                    tag(Tag::True);
+                },
+                [this](const False& f) {
+                    tag(Tag::False);
+                },
+                [this](const Not& n) {
+                    tag(Tag::Not);
+                    this->bexp(n.b_.get());
+                },
+                [this](const BooleanOp& op) {
+                    tag(Tag::BooleanOp);
+                    varint(operator_code(op.op_));
+                    this->bexp(op.lhs_.get());
+                    this->bexp(op.rhs_.get());
+                },
+                [this](const RelationalOp& op) {
+                    tag(Tag::RelationalOp);
+                    varint(operator_code(op.op_));
+                    aexp(op.lhs_.get());
+                    aexp(op.rhs_.get());
+                }
+            };
+
+            std::visit(visitor, *bexp);
+        }
+
+        void tag(Tag tag) {
+            nodes_.push_back(static_cast<char>(tag));
+        }
+
+        void varint(std::uint64_t value) {
+            write_varint(nodes_, value);
+        }
+
+        // Zigzag encoded difference, so decreasing program points stay short as well
+        void pp(PP pp) {
+            const auto delta = static_cast<std::int64_t>(pp) - static_cast<std::int64_t>(last_pp_);
+            varint((static_cast<std::uint64_t>(delta) << 1) ^ static_cast<std::uint64_t>(delta >> 63));
+            last_pp_ = pp;
+        }
+
+        std::uint64_t name(const std::string& name) {
+            const auto [it, inserted] = indices_.emplace(name, indices_.size());
+            if (inserted) {
+                write_varint(names_, name.size());
+                names_ += name;
+            }
+            return it->second;
+        }
+
+        static std::uint64_t operator_code(const std::string& op) {
+            for (std::size_t i = 0; i < operators.size(); ++i) {
+                if (operators[i] == op) return i;
+            }
+            throw std::runtime_error("Unknown operator " + op + "!");
+        }
+
+    public:
+        static void write_varint(std::string& out, std::uint64_t value) {
+            while (value >= 0x80) {
+                out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<char>(value));
+        }
+    };
+
+    class Reader {
+    public:
+        explicit Reader(std::string_view data): data_{data} {}
+
+        void names() {
+            const auto n = varint();
+            for (std::uint64_t i = 0; i < n; ++i) {
+                const auto length = varint();
+                if (length > data_.size() - pos_) malformed();
+                names_.emplace_back(data_.substr(pos_, length));
+                pos_ += length;
+            }
+        }
+
+        std::unique_ptr<Stmt> stmt() {
+            const Nesting nesting{*this};
+            switch (tag()) {
+                case Tag::Skip:
+                    return std::make_unique<Stmt>(Skip{pp()});
+                case Tag::Assign: {
+                    const auto assign_pp = pp();
+                    auto var = std::make_unique<Var>(Var{name()});
+                    return std::make_unique<Stmt>(Assign{assign_pp, std::move(var), aexp()});
+                }
+                case Tag::If: {
+                    auto cond = condition();
+                    auto then_stmt = stmt();
+                    return std::make_unique<Stmt>(If{std::move(cond), std::move(then_stmt), stmt()});
+                }
+                case Tag::While: {
+                    auto cond = condition();
+                    return std::make_unique<Stmt>(While{std::move(cond), stmt()});
+                }
+                case Tag::Seq: {
+                    const auto n = varint();
+                    // Every statement takes at least two bytes, do not trust n for the allocation
+                    if (n < 2 || n > (data_.size() - pos_) / 2) malformed();
+
+                    std::vector<std::unique_ptr<Stmt>> elements{};
+                    elements.reserve(n);
+                    for (std::uint64_t i = 0; i < n; ++i) elements.push_back(stmt());
+
+                    auto seq = std::move(elements.back());
+                    for (std::size_t i = n - 1; i-- > 0;) {
+                        seq = std::make_unique<Stmt>(SeqComp{std::move(elements[i]), std::move(seq)});
+                    }
+                    return seq;
+                }
+                default:
+                    malformed();
+            }
+        }
+
+        [[nodiscard]] bool at_end() const { return pos_ == data_.size(); }
+
+        std::uint64_t varint() {
+            std::uint64_t value = 0;
+            for (unsigned int shift = 0; shift < 64; shift += 7) {
+                if (pos_ == data_.size()) malformed();
+
+                const auto byte = static_cast<std::uint8_t>(data_[pos_++]);
+                value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+                if (!(byte & 0x80)) return value;
+            }
+            malformed();
+        }
+
+    private:
+        // Decoding recurses once per nested node, deeper input is rejected before it exhausts the stack
+        static constexpr unsigned int max_depth = 4096;
+
+        std::string_view data_;
+        std::size_t pos_{0};
+        std::vector<std::string> names_;
+        PP last_pp_{0};
+        unsigned int depth_{0};
+
+        class Nesting {
+        public:
+            explicit Nesting(Reader& reader): reader_{reader} {
+                if (reader_.depth_ == max_depth) malformed();
+                ++reader_.depth_;
+            }
+            ~Nesting() { --reader_.depth_; }
+
+            Nesting(const Nesting&) = delete;
+            auto operator=(const Nesting&) -> Nesting& = delete;
+
+        private:
+            Reader& reader_;
+        };
+
+        std::unique_ptr<AExp> aexp() {
+            const Nesting nesting{*this};
+            switch (tag()) {
+                case Tag::Var:
+                    return std::make_unique<AExp>(Var{name()});
+                case Tag::Num:
+                    return std::make_unique<AExp>(Num{narrow<unsigned int>(varint())});
+                case Tag::ArithmeticOp: {
+                    auto op = operator_spelling();
+                    auto lhs = aexp();
+                    return std::make_unique<AExp>(ArithmeticOp{std::move(lhs), std::move(op), aexp()});
+                }
+                default:
+                    malformed();
+            }
+        }
+
+        std::unique_ptr<BExp> bexp() {
+            const Nesting nesting{*this};
+            switch (tag()) {
+                case Tag::True:
+                    return std::make_unique<BExp>(True{});
+                case Tag::False:
+                    return std::make_unique<BExp>(False{});
+                case Tag::Not:
+                    return std::make_unique<BExp>(Not{bexp()});
+                case Tag::BooleanOp: {
+                    auto op = operator_spelling();
+                    auto lhs = bexp();
+                    return std::make_unique<BExp>(BooleanOp{std::move(lhs), std::move(op), bexp()});
+                }
+                case Tag::RelationalOp: {
+                    auto op = operator_spelling();
+                    auto lhs = aexp();
+                    return std::make_unique<BExp>(RelationalOp{std::move(lhs), std::move(op), aexp()});
+                }
+                default:
+                    malformed();
+            }
+        }
+
+        std::unique_ptr<Cond> condition() {
+            const auto cond_pp = pp();
+            return std::make_unique<Cond>(cond_pp, bexp());
+        }
+
+        Tag tag() {
+            if (pos_ == data_.size()) malformed();
+            return static_cast<Tag>(data_[pos_++]);
+        }
+
+        PP pp() {
+            const auto zigzag = varint();
+            const auto delta = static_cast<std::int64_t>(zigzag >> 1) ^ -static_cast<std::int64_t>(zigzag & 1);
+            last_pp_ = narrow<PP>(static_cast<std::int64_t>(last_pp_) + delta);
+            return last_pp_;
+        }
+
+        std::string name() {
+            const auto index = varint();
+            if (index >= names_.size()) malformed();
+            return names_[index];
+        }
+
+        std::string operator_spelling() {
+            const auto code = varint();
+            if (code >= operators.size()) malformed();
+            return std::string{operators[code]};
+        }
+
+        template<typename T, typename V>
+        static T narrow(V value) {
+            if (value < 0 || static_cast<std::uint64_t>(value) > std::numeric_limits<T>::max()) malformed();
+            return static_cast<T>(value);
+        }
+
+        [[noreturn]] static void malformed() {
+            throw std::runtime_error("Malformed binary AST!");
+        }
+    };
+}
+
+std::string ast_binary::write(const Stmt* stmt) {
+    if (!stmt) throw std::invalid_argument("Given Stmt is empty!");
+
+    Writer writer{};
+    writer.stmt(stmt);
+
+    std::string out{file_magic};
+    out.push_back(static_cast<char>(version));
+    Writer::write_varint(out, writer.n_names());
+    out += writer.names_;
+    out += writer.nodes_;
+    return out;
+}
+
+void ast_binary::write_file(const Stmt* stmt, const std::filesystem::path& path) {
+    const auto data = write(stmt);
+
+    std::ofstream file{path, std::ios::binary | std::ios::trunc};
+    if (!file.is_open()) throw std::runtime_error("Error while opening file " + path.string() + "!");
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!file) throw std::runtime_error("Error while writing file " + path.string() + "!");
+}
+
+std::unique_ptr<Stmt> ast_binary::read(std::string_view data) {
+    if (!data.starts_with(file_magic) || data.size() <= file_magic.size()) {
+        throw std::runtime_error("Not a binary AST!");
+    }
+
+    const auto file_version = static_cast<std::uint8_t>(data[file_magic.size()]);
+    if (file_version != version) {
+        throw std::runtime_error("Unsupported binary AST version " + std::to_string(file_version) + "!");
+    }
+
+    Reader reader{data.substr(file_magic.size() + 1)};
+    reader.names();
+    auto stmt = reader.stmt();
+    if (!reader.at_end()) throw std::runtime_error("Malformed binary AST!");
+
+    return stmt;
+}
+
+std::unique_ptr<Stmt> ast_binary::read_file(const std::filesystem::path& path) {
+    const ProgramSource source{path};
+    return read(source.text());
+}
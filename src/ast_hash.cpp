@@ -0,0 +1,152 @@
+#include "ast_hash.hpp"
+
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include "utils.hpp"
+
+
+namespace {
+    // Distinct seeds per node kind, so e.g. skip and true or x + y and x - y never collide by construction
+    enum class Tag: ast_hash::Hash {
+        Skip = 1, Assign, If, While, SeqComp,
+        Var, Num, ArithmeticOp,
+        True, False, Not, BooleanOp, RelationalOp
+    };
+
+    // Boost-style combine followed by the splitmix64 finalizer, order sensitive
+    ast_hash::Hash combine(ast_hash::Hash seed, ast_hash::Hash value) {
+        ast_hash::Hash x = seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ull;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebull;
+        x ^= x >> 31;
+        return x;
+    }
+
+    // FNV-1a
+    ast_hash::Hash hash_string(std::string_view text) {
+        ast_hash::Hash hash = 14695981039346656037ull;
+        for (const unsigned char c: text) {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    ast_hash::Hash seed(Tag tag) {
+        return combine(0, static_cast<ast_hash::Hash>(tag));
+    }
+
+    /*
+     * Hashes stmt and records the hash of every statement within it. Sequences are walked along their right
+     * spine without recursion, long programs are deeply nested there.
+     */
+    ast_hash::Hash visit(const Stmt* stmt, ast_hash::StmtHashes& hashes) {
+        std::vector<const SeqComp*> spine{};
+        std::vector<const Stmt*> spine_stmts{};
+        while (const auto* sc = std::get_if<SeqComp>(stmt)) {
+            spine.push_back(sc);
+            spine_stmts.push_back(stmt);
+            stmt = sc->snd_.get();
+        }
+
+        auto visitor = overload {
+            [](const Skip& s) {
+                return seed(Tag::Skip);
+            },
+            [](const Assign& a) {
+                auto hash = combine(seed(Tag::Assign), hash_string(a.var_->name_));
+                return combine(hash, ast_hash::hash_aexp(a.aexp_.get()));
+            },
+            [&hashes](const If& i) {
+                auto hash = combine(seed(Tag::If), ast_hash::hash_bexp(i.cond_->bexp_.get()));
+                hash = combine(hash, visit(i.then_.get(), hashes));
+                return combine(hash, visit(i.else_.get(), hashes));
+            },
+            [&hashes](const While& w) {
+                auto hash = combine(seed(Tag::While), ast_hash::hash_bexp(w.cond_->bexp_.get()));
+                return combine(hash, visit(w.body_.get(), hashes));
+            },
+            [](const SeqComp& sc) -> ast_hash::Hash {
+                throw std::logic_error("Sequences are hashed along the spine!");
+            }
+        };
+
+        auto hash = std::visit(visitor, *stmt);
+        hashes.insert_or_assign(stmt, hash);
+
+        for (std::size_t i = spine.size(); i-- > 0;) {
+            auto fst = visit(spine[i]->fst_.get(), hashes);
+            hash = combine(combine(seed(Tag::SeqComp), fst), hash);
+            hashes.insert_or_assign(spine_stmts[i], hash);
+        }
+
+        return hash;
+    }
+}
+
+ast_hash::Hash ast_hash::hash_aexp(const AExp* aexp) {
+    if (!aexp) throw std::invalid_argument("Given AExp is empty!");
+
+    auto visitor = overload {
+        [](const Var& v) {
+            return combine(seed(Tag::Var), hash_string(v.name_));
+        },
+        [](const Num& n) {
+            return combine(seed(Tag::Num), n.val_);
+        },
+        [](const ArithmeticOp& op) {
+            auto hash = combine(seed(Tag::ArithmeticOp), hash_string(op.op_));
+            hash = combine(hash, hash_aexp(op.lhs_.get()));
+            return combine(hash, hash_aexp(op.rhs_.get()));
+        }
+    };
+
+    return std::visit(visitor, *aexp);
+}
+
+ast_hash::Hash ast_hash::hash_bexp(const BExp* bexp) {
+    if (!bexp) throw std::invalid_argument("Given BExp is empty!");
+
+    auto visitor = overload {
+        [](const True& t) {
+            return seed(Tag::True);
+        },
+        [](const False& f) {
+            return seed(Tag::False);
+        },
+        [](const Not& n) {
+            return combine(seed(Tag::Not), hash_bexp(n.b_.get()));
+        },
+        [](const BooleanOp& op) {
+            auto hash = combine(seed(Tag::BooleanOp), hash_string(op.op_));
+            hash = combine(hash, hash_bexp(op.lhs_.get()));
+            return combine(hash, hash_bexp(op.rhs_.get()));
+        },
+        [](const RelationalOp& op) {
+            auto hash = combine(seed(Tag::RelationalOp), hash_string(op.op_));
+            hash = combine(hash, hash_aexp(op.lhs_.get()));
+            return combine(hash, hash_aexp(op.rhs_.get()));
+        }
+    };
+
+    return std::visit(visitor, *bexp);
+}
+
+ast_hash::Hash ast_hash::hash_stmt(const Stmt* stmt) {
+    if (!stmt) throw std::invalid_argument("Given Stmt is empty!");
+
+    StmtHashes hashes{};
+    return visit(stmt, hashes);
+}
+
+ast_hash::StmtHashes ast_hash::hash_statements(const Stmt* stmt) {
+    if (!stmt) throw std::invalid_argument("Given Stmt is empty!");
+
+    StmtHashes hashes{};
+    visit(stmt, hashes);
+    return hashes;
+}
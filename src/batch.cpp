@@ -0,0 +1,161 @@
+#include "batch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+#include "bulk_loader.hpp"
+#include "io.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "lv.hpp"
+#include "summary_cache.hpp"
+#include "thread_pool.hpp"
+
+
+std::vector<std::filesystem::path> batch::collect_inputs(const std::filesystem::path& input) {
+    std::vector<std::filesystem::path> paths{};
+
+    if (std::filesystem::is_directory(input)) {
+        for (const auto& entry: std::filesystem::recursive_directory_iterator(input)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".wlang") {
+                paths.push_back(entry.path());
+            }
+        }
+        // Directory iteration order is unspecified, sort for reproducible result files
+        std::sort(paths.begin(), paths.end());
+    }
+    else if (input.extension() == ".wlang") {
+        paths.push_back(input);
+    }
+    else {
+        std::ifstream list{input};
+        if (!list.is_open()) throw std::runtime_error("Error while opening file list " + input.string() + "!");
+
+        std::string line{};
+        while (std::getline(list, line)) {
+            if (!line.empty()) paths.emplace_back(line);
+        }
+    }
+
+    return paths;
+}
+
+BatchResult batch::analyze_file(const std::filesystem::path& path, LVSolver solver, SummaryCache* summaries) {
+    try {
+        const WLangReader reader{path};
+        if (!reader.is_open()) throw std::runtime_error("Error while opening file!");
+
+        return analyze_program(path, reader.read_program(), solver, summaries);
+    } catch (const std::exception& e) {
+        return {path, false, e.what(), 0, ""};
+    }
+}
+
+BatchResult batch::analyze_program(const std::filesystem::path& path, std::string program_text, LVSolver solver,
+                                   SummaryCache* summaries) {
+    BatchResult result{path, false, "", 0, ""};
+
+    try {
+        // Same check as WLangReader, the bulk loader reads any file
+        if (path.extension() != ".wlang") throw std::runtime_error("Wrong file type!");
+
+        Lexer lexer{std::move(program_text)};
+        Parser parser{lexer.tokenize()};
+        const auto stmt = parser.parse();
+
+        LiveVariablesVec lvs{};
+        if (summaries) {
+            LiveVariableAnalysis::check_constraints(stmt.get());
+            const LiveVariableAnalysis lv{stmt.get(), summaries->program_info(stmt.get())};
+            lvs = solver == LVSolver::Structural
+                ? lv.compute_structural(result.iterations_, *summaries)
+                : lv.compute(solver, result.iterations_);
+        } else {
+            const LiveVariableAnalysis lv{stmt.get()};
+            lvs = lv.compute(solver, result.iterations_);
+        }
+
+        std::ostringstream output{};
+        LiveVariableAnalysis::print_result(lvs, output);
+        result.output_ = output.str();
+        result.ok_ = true;
+    } catch (const std::exception& e) {
+        result.error_ = e.what();
+    }
+
+    return result;
+}
+
+std::vector<BatchResult> batch::run(const std::vector<std::filesystem::path>& paths, unsigned int n_threads,
+                                    LVSolver solver, SummaryCache* summaries) {
+    if (solver == LVSolver::ParallelRoundRobin || solver == LVSolver::ParallelSCC) {
+        throw std::invalid_argument("Batch mode runs files in parallel, use a sequential solver!");
+    }
+
+    std::vector<BatchResult> results(paths.size());
+
+    // Loaded texts not yet analyzed, declared before the pool so it outlives the tasks
+    std::atomic<std::size_t> in_flight{0};
+
+    BulkLoader loader{};
+    ThreadPool pool{n_threads};
+
+    // Load in chunks, the next chunk is loaded while the previous one is analyzed. A chunk is only loaded once at
+    // most one chunk of texts is left, so no more than two chunks are in memory and no chunk waits for the last one.
+    for (std::size_t begin = 0; begin < paths.size(); begin += load_chunk_size) {
+        for (auto n = in_flight.load(); n > load_chunk_size; n = in_flight.load()) in_flight.wait(n);
+
+        const std::size_t end = std::min(begin + load_chunk_size, paths.size());
+        auto files = std::make_shared<std::vector<LoadedFile>>(loader.load({paths.begin() + begin, paths.begin() + end}));
+        in_flight += files->size();
+
+        // Every task writes its own slot, no further synchronization needed
+        for (std::size_t i = 0; i < files->size(); ++i) {
+            pool.submit([&results, &in_flight, files, begin, i, solver, summaries]() {
+                auto& file = (*files)[i];
+                results[begin + i] = file.ok_
+                    ? analyze_program(file.path_, std::move(file.text_), solver, summaries)
+                    : BatchResult{file.path_, false, file.error_, 0, ""};
+
+                --in_flight;
+                in_flight.notify_one();
+            });
+        }
+    }
+    pool.wait();
+
+    return results;
+}
+
+void batch::write_result(const BatchResult& result, std::ostream& os) {
+    os << "== " << result.path_.string() << "\n";
+    if (result.ok_) {
+        os << "status: ok\n";
+        os << "iterations: " << result.iterations_ << "\n";
+        os << result.output_;
+    } else {
+        os << "status: error\n";
+        os << "error: " << result.error_ << "\n";
+    }
+}
+
+void batch::write_summary(std::size_t analyzed, std::size_t failed, std::ostream& os) {
+    os << "== summary\n";
+    os << "analyzed: " << analyzed << "\n";
+    os << "failed: " << failed << "\n";
+}
+
+void batch::write_results(const std::vector<BatchResult>& results, std::ostream& os) {
+    std::size_t failed = 0;
+
+    for (const auto& result: results) {
+        write_result(result, os);
+        if (!result.ok_) ++failed;
+    }
+
+    write_summary(results.size(), failed, os);
+}
@@ -0,0 +1,285 @@
+#include "batch_executor.hpp"
+
+#include <stdexcept>
+
+
+namespace {
+    using Node = BatchProgram::Node;
+    using NodeKind = BatchProgram::NodeKind;
+
+    // GCC/Clang vector extension types, lowered to the widest SIMD registers of the target
+    template<typename T, unsigned int L>
+    struct SimdVector {
+        typedef T type __attribute__((vector_size(L * sizeof(T))));
+    };
+
+    /**
+     * Registers of one group of L states. Every variable is one SIMD vector with a lane per state,
+     * masks use all bits set for active lanes and zero for inactive ones.
+     */
+    template<unsigned int L>
+    class LaneGroup {
+    public:
+        using Vec = typename SimdVector<Value, L>::type;
+        using UVec = typename SimdVector<std::uint64_t, L>::type;
+
+        LaneGroup(const std::vector<Node>& nodes, std::size_t n_slots): nodes_{nodes}, regs_(n_slots) {}
+
+        void run(unsigned int root, const StateColumns& in, StateColumns& out, std::size_t offset) {
+            const std::size_t count = std::min<std::size_t>(L, in.empty() ? 0 : in.front().size() - offset);
+
+            Vec mask{};
+            for (unsigned int slot = 0; slot < regs_.size(); ++slot) {
+                Vec& reg = regs_[slot];
+                reg = Vec{};
+                for (std::size_t lane = 0; lane < count; ++lane) reg[lane] = in[slot][offset + lane];
+            }
+            for (std::size_t lane = 0; lane < count; ++lane) mask[lane] = -1;
+
+            exec(root, mask);
+
+            for (unsigned int slot = 0; slot < regs_.size(); ++slot) {
+                for (std::size_t lane = 0; lane < count; ++lane) out[slot][offset + lane] = regs_[slot][lane];
+            }
+        }
+
+    private:
+        const std::vector<Node>& nodes_;
+        std::vector<Vec> regs_;
+
+        static bool any(const Vec& mask) {
+            for (unsigned int lane = 0; lane < L; ++lane) {
+                if (mask[lane]) return true;
+            }
+            return false;
+        }
+
+        void exec(unsigned int idx, const Vec& mask) {
+            const Node& node = nodes_[idx];
+
+            switch (node.kind_) {
+                case NodeKind::Skip:
+                    break;
+                case NodeKind::Assign: {
+                    Vec value{};
+                    eval(node.b_, value);
+                    Vec& reg = regs_[node.a_];
+                    reg = (value & mask) | (reg & ~mask);
+                    break;
+                }
+                case NodeKind::If: {
+                    Vec cond;
+                    test(node.a_, cond);
+                    const Vec then_mask = mask & cond;
+                    const Vec else_mask = mask & ~cond;
+                    if (any(then_mask)) exec(node.b_, then_mask);
+                    if (any(else_mask)) exec(node.c_, else_mask);
+                    break;
+                }
+                case NodeKind::While: {
+                    // Lanes whose condition fails drop out of the mask and stay retired
+                    Vec active = mask;
+                    while (true) {
+                        Vec cond;
+                        test(node.a_, cond);
+                        active &= cond;
+                        if (!any(active)) break;
+                        exec(node.b_, active);
+                    }
+                    break;
+                }
+                case NodeKind::Seq:
+                    exec(node.a_, mask);
+                    exec(node.b_, mask);
+                    break;
+                default:
+                    throw std::runtime_error("Expected statement node!");
+            }
+        }
+
+        void eval(unsigned int idx, Vec& out) {
+            const Node& node = nodes_[idx];
+
+            switch (node.kind_) {
+                case NodeKind::Var:
+                    out = regs_[node.a_];
+                    break;
+                case NodeKind::Num:
+                    out = Vec{} + node.value_;
+                    break;
+                case NodeKind::Arithmetic: {
+                    // Unsigned lanes, so that overflow wraps like in the interpreter
+                    Vec lhs, rhs;
+                    eval(node.a_, lhs);
+                    eval(node.b_, rhs);
+                    switch (static_cast<ArithmeticOpKind>(node.op_)) {
+                        case ArithmeticOpKind::Add: out = (Vec)((UVec)lhs + (UVec)rhs); break;
+                        case ArithmeticOpKind::Sub: out = (Vec)((UVec)lhs - (UVec)rhs); break;
+                        case ArithmeticOpKind::Mul: out = (Vec)((UVec)lhs * (UVec)rhs); break;
+                        default: throw std::runtime_error("Unknown arithmetic operator!");
+                    }
+                    break;
+                }
+                default:
+                    throw std::runtime_error("Expected arithmetic expression node!");
+            }
+        }
+
+        void test(unsigned int idx, Vec& out) {
+            const Node& node = nodes_[idx];
+
+            switch (node.kind_) {
+                case NodeKind::True:
+                    out = Vec{} - 1;
+                    break;
+                case NodeKind::False:
+                    out = Vec{};
+                    break;
+                case NodeKind::Not:
+                    test(node.a_, out);
+                    out = ~out;
+                    break;
+                case NodeKind::And:
+                case NodeKind::Or: {
+                    Vec rhs;
+                    test(node.a_, out);
+                    test(node.b_, rhs);
+                    out = (node.kind_ == NodeKind::And) ? (out & rhs) : (out | rhs);
+                    break;
+                }
+                case NodeKind::Relational: {
+                    Vec lhs, rhs;
+                    eval(node.a_, lhs);
+                    eval(node.b_, rhs);
+                    switch (static_cast<RelationalOpKind>(node.op_)) {
+                        case RelationalOpKind::Lt: out = lhs < rhs; break;
+                        case RelationalOpKind::Le: out = lhs <= rhs; break;
+                        case RelationalOpKind::Gt: out = lhs > rhs; break;
+                        case RelationalOpKind::Ge: out = lhs >= rhs; break;
+                        default: throw std::runtime_error("Unknown relational operator!");
+                    }
+                    break;
+                }
+                default:
+                    throw std::runtime_error("Expected boolean expression node!");
+            }
+        }
+    };
+}
+
+
+BatchProgram::BatchProgram(const Stmt* stmt): slots_{interpreter::var_slots(stmt)} {
+    root_ = compile_stmt(stmt);
+}
+
+template<unsigned int Lanes>
+StateColumns BatchProgram::run(const StateColumns& initial) const {
+    if (initial.size() != slots_.size()) throw std::runtime_error("Expected one column per variable!");
+
+    const std::size_t n_states = initial.empty() ? 0 : initial.front().size();
+    for (const auto& column: initial) {
+        if (column.size() != n_states) throw std::runtime_error("Columns differ in length!");
+    }
+
+    StateColumns result(slots_.size(), std::vector<Value>(n_states));
+    LaneGroup<Lanes> group{nodes_, slots_.size()};
+
+    for (std::size_t offset = 0; offset < n_states; offset += Lanes) {
+        group.run(root_, initial, result, offset);
+    }
+
+    return result;
+}
+
+template StateColumns BatchProgram::run<8>(const StateColumns&) const;
+template StateColumns BatchProgram::run<16>(const StateColumns&) const;
+
+unsigned int BatchProgram::add(Node node) {
+    nodes_.push_back(node);
+    return nodes_.size() - 1;
+}
+
+unsigned int BatchProgram::compile_stmt(const Stmt* stmt) {
+    if (!stmt) throw std::invalid_argument("Given Stmt is empty!");
+
+    auto visitor = overload {
+        [this](const Skip& s) {
+            return add({NodeKind::Skip, 0, 0, 0, 0, 0});
+        },
+        [this](const Assign& a) {
+            const auto slot = slots_.at(a.var_->name_);
+            const auto aexp = compile_aexp(a.aexp_.get());
+            return add({NodeKind::Assign, 0, slot, aexp, 0, 0});
+        },
+        [this](const If& i) {
+            const auto cond = compile_bexp(i.cond_->bexp_.get());
+            const auto then_branch = compile_stmt(i.then_.get());
+            const auto else_branch = compile_stmt(i.else_.get());
+            return add({NodeKind::If, 0, cond, then_branch, else_branch, 0});
+        },
+        [this](const While& w) {
+            const auto cond = compile_bexp(w.cond_->bexp_.get());
+            const auto body = compile_stmt(w.body_.get());
+            return add({NodeKind::While, 0, cond, body, 0, 0});
+        },
+        [this](const SeqComp& sc) {
+            const auto fst = compile_stmt(sc.fst_.get());
+            const auto snd = compile_stmt(sc.snd_.get());
+            return add({NodeKind::Seq, 0, fst, snd, 0, 0});
+        }
+    };
+
+    return std::visit(visitor, *stmt);
+}
+
+unsigned int BatchProgram::compile_aexp(const AExp* aexp) {
+    if (!aexp) throw std::invalid_argument("Given AExp is empty!");
+
+    auto visitor = overload {
+        [this](const Var& var) {
+            return add({NodeKind::Var, 0, slots_.at(var.name_), 0, 0, 0});
+        },
+        [this](const Num& num) {
+            return add({NodeKind::Num, 0, 0, 0, 0, num.val_});
+        },
+        [this](const ArithmeticOp& opa) {
+            const auto op = static_cast<std::uint8_t>(interpreter::arithmetic_op_kind(opa.op_));
+            const auto lhs = compile_aexp(opa.lhs_.get());
+            const auto rhs = compile_aexp(opa.rhs_.get());
+            return add({NodeKind::Arithmetic, op, lhs, rhs, 0, 0});
+        }
+    };
+
+    return std::visit(visitor, *aexp);
+}
+
+unsigned int BatchProgram::compile_bexp(const BExp* bexp) {
+    if (!bexp) throw std::invalid_argument("Given BExp is empty!");
+
+    auto visitor = overload {
+        [this](const True&) {
+            return add({NodeKind::True, 0, 0, 0, 0, 0});
+        },
+        [this](const False&) {
+            return add({NodeKind::False, 0, 0, 0, 0, 0});
+        },
+        [this](const Not& n) {
+            const auto b = compile_bexp(n.b_.get());
+            return add({NodeKind::Not, 0, b, 0, 0, 0});
+        },
+        [this](const BooleanOp& opb) {
+            const auto kind = (interpreter::boolean_op_kind(opb.op_) == BooleanOpKind::And) ? NodeKind::And : NodeKind::Or;
+            const auto lhs = compile_bexp(opb.lhs_.get());
+            const auto rhs = compile_bexp(opb.rhs_.get());
+            return add({kind, 0, lhs, rhs, 0, 0});
+        },
+        [this](const RelationalOp& opr) {
+            const auto op = static_cast<std::uint8_t>(interpreter::relational_op_kind(opr.op_));
+            const auto lhs = compile_aexp(opr.lhs_.get());
+            const auto rhs = compile_aexp(opr.rhs_.get());
+            return add({NodeKind::Relational, op, lhs, rhs, 0, 0});
+        }
+    };
+
+    return std::visit(visitor, *bexp);
+}
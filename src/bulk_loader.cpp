@@ -0,0 +1,356 @@
+#include "bulk_loader.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <fstream>
+
+#include "thread_pool.hpp"
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define SDPA_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+#if __has_include(<unistd.h>)
+#define SDPA_POSIX_IO 1
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+#ifdef SDPA_IO_URING
+/*
+ * Minimal io_uring: the submission and completion rings mapped from the kernel, accessed with
+ * acquire/release on the shared head and tail indices.
+ */
+struct BulkLoader::Ring {
+    int fd_{-1};
+    unsigned int entries_{0};
+
+    void* sq_ptr_{nullptr};
+    std::size_t sq_size_{0};
+    void* cq_ptr_{nullptr};
+    std::size_t cq_size_{0};
+    io_uring_sqe* sqes_{nullptr};
+    std::size_t sqes_size_{0};
+
+    unsigned int* sq_head_{nullptr};
+    unsigned int* sq_tail_{nullptr};
+    unsigned int* sq_mask_{nullptr};
+    unsigned int* sq_array_{nullptr};
+    unsigned int* cq_head_{nullptr};
+    unsigned int* cq_tail_{nullptr};
+    unsigned int* cq_mask_{nullptr};
+    io_uring_cqe* cqes_{nullptr};
+
+    unsigned int to_submit_{0};
+    unsigned int local_tail_{0};        // SQ tail including the entries not yet published to the kernel
+
+    // Returns nullptr if the kernel does not provide io_uring
+    static std::unique_ptr<Ring> create(unsigned int entries) {
+        io_uring_params params{};
+        const int fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0) return nullptr;
+
+        auto ring = std::make_unique<Ring>();
+        ring->fd_ = fd;
+        ring->entries_ = params.sq_entries;
+
+        ring->sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+        ring->cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single_mmap) ring->sq_size_ = ring->cq_size_ = std::max(ring->sq_size_, ring->cq_size_);
+
+        ring->sq_ptr_ = mmap(nullptr, ring->sq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (ring->sq_ptr_ == MAP_FAILED) { ring->sq_ptr_ = nullptr; return nullptr; }
+
+        if (single_mmap) ring->cq_ptr_ = ring->sq_ptr_;
+        else {
+            ring->cq_ptr_ = mmap(nullptr, ring->cq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            if (ring->cq_ptr_ == MAP_FAILED) { ring->cq_ptr_ = nullptr; return nullptr; }
+        }
+
+        ring->sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = mmap(nullptr, ring->sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) return nullptr;
+        ring->sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+        auto* sq = static_cast<char*>(ring->sq_ptr_);
+        ring->sq_head_ = reinterpret_cast<unsigned int*>(sq + params.sq_off.head);
+        ring->sq_tail_ = reinterpret_cast<unsigned int*>(sq + params.sq_off.tail);
+        ring->sq_mask_ = reinterpret_cast<unsigned int*>(sq + params.sq_off.ring_mask);
+        ring->sq_array_ = reinterpret_cast<unsigned int*>(sq + params.sq_off.array);
+        ring->local_tail_ = *ring->sq_tail_;
+
+        auto* cq = static_cast<char*>(ring->cq_ptr_);
+        ring->cq_head_ = reinterpret_cast<unsigned int*>(cq + params.cq_off.head);
+        ring->cq_tail_ = reinterpret_cast<unsigned int*>(cq + params.cq_off.tail);
+        ring->cq_mask_ = reinterpret_cast<unsigned int*>(cq + params.cq_off.ring_mask);
+        ring->cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        return ring;
+    }
+
+    ~Ring() {
+        if (sqes_) munmap(sqes_, sqes_size_);
+        if (cq_ptr_ && cq_ptr_ != sq_ptr_) munmap(cq_ptr_, cq_size_);
+        if (sq_ptr_) munmap(sq_ptr_, sq_size_);
+        if (fd_ >= 0) close(fd_);
+    }
+
+    // The caller never queues more than entries_ requests between two calls of submit_and_wait.
+    // The entry is only filled in after this returns, so the tail the kernel sees is advanced in submit_and_wait.
+    io_uring_sqe* next_sqe() {
+        const unsigned int idx = local_tail_++ & *sq_mask_;
+
+        io_uring_sqe* sqe = &sqes_[idx];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sq_array_[idx] = idx;
+
+        ++to_submit_;
+        return sqe;
+    }
+
+    /*
+     * Submits all queued requests, waits for their completions and hands them to on_complete(user_data, res).
+     */
+    template<typename F>
+    bool submit_and_wait(F&& on_complete) {
+        const unsigned int expected = to_submit_;
+        unsigned int completed = 0;
+
+        // Publish the entries of this round at once, after all of them are written
+        std::atomic_ref<unsigned int>{*sq_tail_}.store(local_tail_, std::memory_order_release);
+
+        while (completed < expected) {
+            const unsigned int submit = to_submit_;
+            const long ret = syscall(__NR_io_uring_enter, fd_, submit, expected - completed, IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (ret < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            to_submit_ -= static_cast<unsigned int>(ret);
+
+            unsigned int head = std::atomic_ref<unsigned int>{*cq_head_}.load(std::memory_order_relaxed);
+            const unsigned int tail = std::atomic_ref<unsigned int>{*cq_tail_}.load(std::memory_order_acquire);
+            for (; head != tail; ++head, ++completed) {
+                const io_uring_cqe& cqe = cqes_[head & *cq_mask_];
+                on_complete(cqe.user_data, cqe.res);
+            }
+            std::atomic_ref<unsigned int>{*cq_head_}.store(head, std::memory_order_release);
+        }
+
+        return true;
+    }
+};
+#else
+struct BulkLoader::Ring {};
+#endif
+
+
+BulkLoader::BulkLoader(unsigned int queue_depth, unsigned int fallback_threads):
+    fallback_threads_{fallback_threads}
+{
+#ifdef SDPA_IO_URING
+    // Every file needs two requests in the first round (open and statx)
+    ring_ = Ring::create(std::max(queue_depth, 2u));
+#endif
+}
+
+BulkLoader::~BulkLoader() = default;
+
+std::vector<LoadedFile> BulkLoader::load(const std::vector<std::filesystem::path>& paths) {
+    std::vector<LoadedFile> files{};
+    files.reserve(paths.size());
+    for (const auto& path: paths) files.push_back({path, false, "", ""});
+
+    if (!ring_) {
+        load_fallback(files);
+        return files;
+    }
+
+#ifdef SDPA_IO_URING
+    const std::size_t batch_size = ring_->entries_ / 2;
+    for (std::size_t begin = 0; begin < files.size(); begin += batch_size) {
+        load_io_uring(files, begin, std::min(begin + batch_size, files.size()));
+    }
+#endif
+
+    return files;
+}
+
+void BulkLoader::load_io_uring(std::vector<LoadedFile>& files, std::size_t begin, std::size_t end) {
+#ifdef SDPA_IO_URING
+    struct Pending {
+        int fd_;
+        struct statx stat_;
+        std::string path_;                  // Keeps the C string alive until the open completed
+        bool stat_ok_;
+        std::size_t size_;
+        std::size_t done_;
+    };
+    std::vector<Pending> pending(end - begin);
+
+    const auto fail = [&files, begin](std::size_t i, const char* error) {
+        files[begin + i].ok_ = false;
+        files[begin + i].error_ = error;
+        files[begin + i].text_.clear();
+    };
+
+    // Round 1: open and query the size, user_data is 2 * i for the open and 2 * i + 1 for the statx
+    for (std::size_t i = 0; i < pending.size(); ++i) {
+        auto& p = pending[i];
+        p.fd_ = -1;
+        p.stat_ok_ = false;
+        p.size_ = 0;
+        p.done_ = 0;
+        p.path_ = files[begin + i].path_.string();
+
+        io_uring_sqe* open = ring_->next_sqe();
+        open->opcode = IORING_OP_OPENAT;
+        open->fd = AT_FDCWD;
+        open->addr = reinterpret_cast<std::uint64_t>(p.path_.c_str());
+        open->open_flags = O_RDONLY | O_CLOEXEC;
+        open->user_data = 2 * i;
+
+        io_uring_sqe* stat = ring_->next_sqe();
+        stat->opcode = IORING_OP_STATX;
+        stat->fd = AT_FDCWD;
+        stat->addr = reinterpret_cast<std::uint64_t>(p.path_.c_str());
+        stat->len = STATX_SIZE;
+        stat->off = reinterpret_cast<std::uint64_t>(&p.stat_);
+        stat->user_data = 2 * i + 1;
+    }
+
+    bool unsupported = false;
+    const bool submitted = ring_->submit_and_wait([&](std::uint64_t user_data, int res) {
+        auto& p = pending[user_data / 2];
+        if (res == -EINVAL) unsupported = true;
+        if (user_data % 2 == 0) p.fd_ = res;
+        else p.stat_ok_ = res >= 0;
+    });
+
+    // Old kernels without these opcodes, do the whole batch the portable way
+    if (!submitted || unsupported) {
+        for (auto& p: pending) if (p.fd_ >= 0) close(p.fd_);
+
+        std::vector<LoadedFile> batch(std::make_move_iterator(files.begin() + begin), std::make_move_iterator(files.begin() + end));
+        load_fallback(batch);
+        std::move(batch.begin(), batch.end(), files.begin() + begin);
+        return;
+    }
+
+    for (std::size_t i = 0; i < pending.size(); ++i) {
+        auto& p = pending[i];
+        if (p.fd_ < 0) fail(i, "Error while opening file!");
+        else if (!p.stat_ok_) fail(i, "Error while reading file!");
+        else {
+            p.size_ = p.stat_.stx_size;
+            files[begin + i].text_.resize(p.size_);
+        }
+    }
+
+    // Round 2..n: read straight into the strings, short reads are continued in the next round
+    while (true) {
+        bool queued = false;
+        for (std::size_t i = 0; i < pending.size(); ++i) {
+            auto& p = pending[i];
+            if (p.fd_ < 0 || !files[begin + i].error_.empty() || p.done_ >= p.size_) continue;
+
+            io_uring_sqe* read = ring_->next_sqe();
+            read->opcode = IORING_OP_READ;
+            read->fd = p.fd_;
+            read->addr = reinterpret_cast<std::uint64_t>(files[begin + i].text_.data() + p.done_);
+            read->len = static_cast<unsigned int>(std::min<std::size_t>(p.size_ - p.done_, 1u << 30));
+            read->off = p.done_;
+            read->user_data = i;
+            queued = true;
+        }
+        if (!queued) break;
+
+        const bool read = ring_->submit_and_wait([&](std::uint64_t i, int res) {
+            auto& p = pending[i];
+            if (res < 0) fail(i, "Error while reading file!");
+            else if (res == 0) {
+                // The file shrank since statx
+                p.size_ = p.done_;
+                files[begin + i].text_.resize(p.size_);
+            }
+            else p.done_ += static_cast<std::size_t>(res);
+        });
+
+        if (!read) {
+            for (std::size_t i = 0; i < pending.size(); ++i) {
+                if (pending[i].done_ < pending[i].size_) fail(i, "Error while reading file!");
+            }
+            break;
+        }
+    }
+
+    // Last round: close everything that was opened
+    for (std::size_t i = 0; i < pending.size(); ++i) {
+        if (pending[i].fd_ < 0) continue;
+
+        io_uring_sqe* close_sqe = ring_->next_sqe();
+        close_sqe->opcode = IORING_OP_CLOSE;
+        close_sqe->fd = pending[i].fd_;
+        close_sqe->user_data = i;
+        if (files[begin + i].error_.empty()) files[begin + i].ok_ = true;
+    }
+    ring_->submit_and_wait([](std::uint64_t, int) {});
+#endif
+}
+
+void BulkLoader::load_fallback(std::vector<LoadedFile>& files) {
+    const auto load_one = [](LoadedFile& file) {
+#ifdef SDPA_POSIX_IO
+        const int fd = open(file.path_.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            file.error_ = "Error while opening file!";
+            return;
+        }
+
+        struct stat st{};
+        if (fstat(fd, &st) == 0) {
+            file.text_.resize(static_cast<std::size_t>(st.st_size));
+
+            std::size_t done = 0;
+            bool failed = false;
+            while (done < file.text_.size()) {
+                const ssize_t n = pread(fd, file.text_.data() + done, file.text_.size() - done, static_cast<off_t>(done));
+                if (n < 0 && errno == EINTR) continue;
+                if (n < 0) failed = true;
+                if (n <= 0) break;
+                done += static_cast<std::size_t>(n);
+            }
+            file.text_.resize(failed ? 0 : done);
+            file.ok_ = !failed;
+            if (failed) file.error_ = "Error while reading file!";
+        }
+        else file.error_ = "Error while reading file!";
+
+        close(fd);
+#else
+        std::ifstream in{file.path_, std::ios::binary | std::ios::ate};
+        if (!in.is_open()) {
+            file.error_ = "Error while opening file!";
+            return;
+        }
+
+        file.text_.resize(static_cast<std::size_t>(in.tellg()));
+        in.seekg(0);
+        in.read(file.text_.data(), static_cast<std::streamsize>(file.text_.size()));
+        file.text_.resize(static_cast<std::size_t>(in.gcount()));
+        file.ok_ = true;
+#endif
+    };
+
+    if (!fallback_pool_) fallback_pool_ = std::make_unique<ThreadPool>(fallback_threads_);
+    for (auto& file: files) {
+        fallback_pool_->submit([&file, &load_one]() { load_one(file); });
+    }
+    fallback_pool_->wait();
+}
@@ -0,0 +1,254 @@
+#include "c_backend.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <dlfcn.h>
+#include <unistd.h>
+
+#ifndef SDPA_C_COMPILER
+#define SDPA_C_COMPILER "clang"
+#endif
+
+
+namespace {
+    constexpr const char* C_FLAGS = "-O2 -fwrapv -shared -fPIC";
+
+    std::uint64_t fnv1a(const std::string& s) {
+        std::uint64_t hash = 14695981039346656037ull;
+        for (const unsigned char c: s) {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    std::string shell_quote(const std::string& s) {
+        std::string quoted = "'";
+        for (const char c: s) {
+            if (c == '\'') quoted += "'\\''";
+            else quoted += c;
+        }
+        return quoted + "'";
+    }
+
+    // Prefix variables so that WL names never clash with C keywords
+    std::string c_name(const std::string& var) {
+        return "v_" + var;
+    }
+
+    class CEmitter {
+    public:
+        explicit CEmitter(std::ostringstream& out): out_{out} {}
+
+        void emit_stmt(const Stmt* stmt, unsigned int depth) {
+            auto visitor = overload {
+                [](const Skip&) {},
+                [this, depth](const Assign& a) {
+                    indent(depth);
+                    out_ << c_name(a.var_->name_) << " = ";
+                    emit_aexp(a.aexp_.get());
+                    out_ << ";\n";
+                },
+                [this, depth](const If& i) {
+                    indent(depth);
+                    out_ << "if ";
+                    emit_bexp(i.cond_->bexp_.get());
+                    out_ << " {\n";
+                    emit_stmt(i.then_.get(), depth + 1);
+                    indent(depth);
+                    out_ << "} else {\n";
+                    emit_stmt(i.else_.get(), depth + 1);
+                    indent(depth);
+                    out_ << "}\n";
+                },
+                [this, depth](const While& w) {
+                    indent(depth);
+                    out_ << "while ";
+                    emit_bexp(w.cond_->bexp_.get());
+                    out_ << " {\n";
+                    emit_stmt(w.body_.get(), depth + 1);
+                    indent(depth);
+                    out_ << "}\n";
+                },
+                [this, depth](const SeqComp& sc) {
+                    emit_stmt(sc.fst_.get(), depth);
+                    emit_stmt(sc.snd_.get(), depth);
+                }
+            };
+
+            std::visit(visitor, *stmt);
+        }
+
+        void emit_aexp(const AExp* aexp) {
+            auto visitor = overload {
+                [this](const Var& var) {
+                    out_ << c_name(var.name_);
+                },
+                [this](const Num& num) {
+                    out_ << "INT64_C(" << num.val_ << ")";
+                },
+                [this](const ArithmeticOp& opa) {
+                    interpreter::arithmetic_op_kind(opa.op_); // reject unknown operators
+                    out_ << "(";
+                    emit_aexp(opa.lhs_.get());
+                    out_ << " " << opa.op_ << " ";
+                    emit_aexp(opa.rhs_.get());
+                    out_ << ")";
+                }
+            };
+
+            std::visit(visitor, *aexp);
+        }
+
+        void emit_bexp(const BExp* bexp) {
+            auto visitor = overload {
+                [this](const True&) {
+                    out_ << "(1)";
+                },
+                [this](const False&) {
+                    out_ << "(0)";
+                },
+                [this](const Not& n) {
+                    out_ << "(!";
+                    emit_bexp(n.b_.get());
+                    out_ << ")";
+                },
+                [this](const BooleanOp& opb) {
+                    const bool is_and = interpreter::boolean_op_kind(opb.op_) == BooleanOpKind::And;
+                    out_ << "(";
+                    emit_bexp(opb.lhs_.get());
+                    out_ << (is_and ? " && " : " || ");
+                    emit_bexp(opb.rhs_.get());
+                    out_ << ")";
+                },
+                [this](const RelationalOp& opr) {
+                    interpreter::relational_op_kind(opr.op_); // reject unknown operators
+                    out_ << "(";
+                    emit_aexp(opr.lhs_.get());
+                    out_ << " " << opr.op_ << " ";
+                    emit_aexp(opr.rhs_.get());
+                    out_ << ")";
+                }
+            };
+
+            std::visit(visitor, *bexp);
+        }
+
+    private:
+        std::ostringstream& out_;
+
+        void indent(unsigned int depth) {
+            out_ << std::string(4 * depth, ' ');
+        }
+    };
+}
+
+
+CProgram::CProgram(const Stmt* stmt): CProgram{stmt, default_cache_dir()} {}
+
+CProgram::CProgram(const Stmt* stmt, std::filesystem::path cache_dir):
+    slots_{interpreter::var_slots(stmt)}, cache_hit_{false}, handle_{nullptr}, fn_{nullptr}
+{
+    const char* env_compiler = std::getenv("SDPA_CC");
+    const std::string compiler = env_compiler ? env_compiler : SDPA_C_COMPILER;
+
+    source_ = emit_c(stmt, slots_);
+
+    // The key covers everything that influences the object file
+    std::ostringstream key{};
+    key << std::hex << fnv1a(compiler + "\n" + C_FLAGS + "\n" + source_);
+
+    std::filesystem::create_directories(cache_dir);
+    object_path_ = cache_dir / ("wl_" + key.str() + ".so");
+
+    cache_hit_ = std::filesystem::exists(object_path_);
+    if (!cache_hit_) compile(compiler);
+
+    handle_ = dlopen(object_path_.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!handle_) throw std::runtime_error(std::string("Could not load compiled program: ") + dlerror());
+
+    fn_ = reinterpret_cast<CompiledFn>(dlsym(handle_, "wl_run"));
+    if (!fn_) {
+        dlclose(handle_);
+        throw std::runtime_error("Compiled program does not export wl_run!");
+    }
+}
+
+CProgram::~CProgram() {
+    if (handle_) dlclose(handle_);
+}
+
+State CProgram::run(const State& state) const {
+    auto values = interpreter::to_slots(state, slots_);
+    run(values.data());
+    return interpreter::from_slots(values, slots_);
+}
+
+std::string CProgram::emit_c(const Stmt* stmt, const VarSlots& slots) {
+    if (!stmt) throw std::invalid_argument("Given Stmt is empty!");
+
+    std::vector<std::string> vars(slots.size());
+    for (const auto& [name, slot]: slots) vars[slot] = name;
+
+    std::ostringstream out{};
+    out << "#include <stdint.h>\n\n";
+
+    // Fields in slot order, so that the struct has the layout of the slot array
+    out << "struct wl_state {\n";
+    for (const auto& var: vars) out << "    int64_t " << c_name(var) << ";\n";
+    if (vars.empty()) out << "    int64_t unused;\n";
+    out << "};\n\n";
+
+    // Variables are copied into locals so that the compiler can keep them in registers
+    out << "void wl_run(struct wl_state* s) {\n";
+    for (const auto& var: vars) out << "    int64_t " << c_name(var) << " = s->" << c_name(var) << ";\n";
+
+    CEmitter emitter{out};
+    emitter.emit_stmt(stmt, 1);
+
+    for (const auto& var: vars) out << "    s->" << c_name(var) << " = " << c_name(var) << ";\n";
+    out << "}\n";
+
+    return out.str();
+}
+
+std::filesystem::path CProgram::default_cache_dir() {
+    if (const char* dir = std::getenv("SDPA_CACHE_DIR")) return dir;
+    if (const char* dir = std::getenv("XDG_CACHE_HOME")) return std::filesystem::path(dir) / "sdpa";
+    if (const char* dir = std::getenv("HOME")) return std::filesystem::path(dir) / ".cache" / "sdpa";
+
+    return std::filesystem::temp_directory_path() / "sdpa";
+}
+
+void CProgram::compile(const std::string& compiler) const {
+    // Build next to the final object and rename it into place, concurrent runs never see partial files.
+    // The temporary names are unique per process and per compilation, threads may compile the same program at once.
+    static std::atomic<unsigned int> compilations{0};
+    const auto tmp_name = object_path_.stem().string()
+        + "." + std::to_string(getpid()) + "." + std::to_string(compilations++);
+    const auto source_path = object_path_.parent_path() / (tmp_name + ".c");
+    const auto tmp_object_path = object_path_.parent_path() / (tmp_name + ".so");
+
+    {
+        std::ofstream file{source_path};
+        file << source_;
+        if (!file) throw std::runtime_error("Could not write generated C source!");
+    }
+
+    const std::string command = compiler + " " + C_FLAGS
+        + " -o " + shell_quote(tmp_object_path.string())
+        + " " + shell_quote(source_path.string());
+    const int status = std::system(command.c_str());
+
+    std::filesystem::remove(source_path);
+    if (status != 0) {
+        std::filesystem::remove(tmp_object_path);
+        throw std::runtime_error("Compilation of generated C failed: " + command);
+    }
+
+    std::filesystem::rename(tmp_object_path, object_path_);
+}
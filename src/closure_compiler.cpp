@@ -0,0 +1,247 @@
+#include "closure_compiler.hpp"
+
+#include <type_traits>
+
+
+namespace {
+    template<ArithmeticOpKind Op>
+    inline Value arithmetic(Value lhs, Value rhs) {
+        // Same wrapping semantics as interpreter::apply
+        const auto l = static_cast<std::uint64_t>(lhs);
+        const auto r = static_cast<std::uint64_t>(rhs);
+
+        if constexpr (Op == ArithmeticOpKind::Add) return static_cast<Value>(l + r);
+        else if constexpr (Op == ArithmeticOpKind::Sub) return static_cast<Value>(l - r);
+        else return static_cast<Value>(l * r);
+    }
+
+    template<RelationalOpKind Op>
+    inline bool relational(Value lhs, Value rhs) {
+        if constexpr (Op == RelationalOpKind::Lt) return lhs < rhs;
+        else if constexpr (Op == RelationalOpKind::Le) return lhs <= rhs;
+        else if constexpr (Op == RelationalOpKind::Gt) return lhs > rhs;
+        else return lhs >= rhs;
+    }
+
+    /*
+     * Lifts the runtime operator into a template argument, so f can instantiate one lambda per operator.
+     */
+    template<typename F>
+    auto with_op(ArithmeticOpKind op, F&& f) {
+        switch (op) {
+            case ArithmeticOpKind::Add: return f(std::integral_constant<ArithmeticOpKind, ArithmeticOpKind::Add>{});
+            case ArithmeticOpKind::Sub: return f(std::integral_constant<ArithmeticOpKind, ArithmeticOpKind::Sub>{});
+            case ArithmeticOpKind::Mul: return f(std::integral_constant<ArithmeticOpKind, ArithmeticOpKind::Mul>{});
+        }
+        throw std::runtime_error("Unknown arithmetic operator!");
+    }
+
+    template<typename F>
+    auto with_op(RelationalOpKind op, F&& f) {
+        switch (op) {
+            case RelationalOpKind::Lt: return f(std::integral_constant<RelationalOpKind, RelationalOpKind::Lt>{});
+            case RelationalOpKind::Le: return f(std::integral_constant<RelationalOpKind, RelationalOpKind::Le>{});
+            case RelationalOpKind::Gt: return f(std::integral_constant<RelationalOpKind, RelationalOpKind::Gt>{});
+            case RelationalOpKind::Ge: return f(std::integral_constant<RelationalOpKind, RelationalOpKind::Ge>{});
+        }
+        throw std::runtime_error("Unknown relational operator!");
+    }
+}
+
+
+ClosureProgram::ClosureProgram(const Stmt* stmt): slots_{interpreter::var_slots(stmt)} {
+    body_ = compile_stmt(stmt);
+}
+
+State ClosureProgram::run(const State& state) const {
+    auto values = interpreter::to_slots(state, slots_);
+    run(values.data());
+    return interpreter::from_slots(values, slots_);
+}
+
+StmtClosure ClosureProgram::compile_stmt(const Stmt* stmt) const {
+    if (!stmt) throw std::invalid_argument("Given Stmt is empty!");
+
+    auto visitor = overload {
+        [](const Skip& s) -> StmtClosure {
+            return [](Value*) {};
+        },
+        [this](const Assign& a) -> StmtClosure {
+            return compile_assign(a);
+        },
+        [this](const If& i) -> StmtClosure {
+            return [cond = compile_bexp(i.cond_->bexp_.get()),
+                    then_branch = compile_stmt(i.then_.get()),
+                    else_branch = compile_stmt(i.else_.get())](Value* s) {
+                if (cond(s)) then_branch(s);
+                else else_branch(s);
+            };
+        },
+        [this](const While& w) -> StmtClosure {
+            return [cond = compile_bexp(w.cond_->bexp_.get()),
+                    body = compile_stmt(w.body_.get())](Value* s) {
+                while (cond(s)) body(s);
+            };
+        },
+        [this, stmt](const SeqComp& sc) -> StmtClosure {
+            // Flatten nested sequences into one loop instead of a chain of closures
+            std::vector<StmtClosure> stmts{};
+            flatten_seq(stmt, stmts);
+
+            if (stmts.empty()) return [](Value*) {};
+            if (stmts.size() == 1) return std::move(stmts.front());
+
+            return [stmts = std::move(stmts)](Value* s) {
+                for (const auto& f: stmts) f(s);
+            };
+        }
+    };
+
+    return std::visit(visitor, *stmt);
+}
+
+void ClosureProgram::flatten_seq(const Stmt* stmt, std::vector<StmtClosure>& out) const {
+    if (const auto* sc = std::get_if<SeqComp>(stmt)) {
+        flatten_seq(sc->fst_.get(), out);
+        flatten_seq(sc->snd_.get(), out);
+    } else if (!std::holds_alternative<Skip>(*stmt)) {
+        out.push_back(compile_stmt(stmt));
+    }
+}
+
+StmtClosure ClosureProgram::compile_assign(const Assign& assign) const {
+    const auto x = slots_.at(assign.var_->name_);
+
+    auto visitor = overload {
+        [x](const Num& num) -> StmtClosure {
+            const Value c = num.val_;
+            return [x, c](Value* s) { s[x] = c; };
+        },
+        [this, x](const Var& var) -> StmtClosure {
+            const auto y = slots_.at(var.name_);
+            return [x, y](Value* s) { s[x] = s[y]; };
+        },
+        [this, x, &assign](const ArithmeticOp& opa) -> StmtClosure {
+            const auto op = interpreter::arithmetic_op_kind(opa.op_);
+            const auto* lhs_var = std::get_if<Var>(opa.lhs_.get());
+            const auto* rhs_var = std::get_if<Var>(opa.rhs_.get());
+            const auto* rhs_num = std::get_if<Num>(opa.rhs_.get());
+
+            // x := (y op n)
+            if (lhs_var && rhs_num) {
+                const auto y = slots_.at(lhs_var->name_);
+                const Value c = rhs_num->val_;
+                return with_op(op, [x, y, c](auto tag) -> StmtClosure {
+                    return [x, y, c](Value* s) { s[x] = arithmetic<decltype(tag)::value>(s[y], c); };
+                });
+            }
+
+            // x := (y op z)
+            if (lhs_var && rhs_var) {
+                const auto y = slots_.at(lhs_var->name_);
+                const auto z = slots_.at(rhs_var->name_);
+                return with_op(op, [x, y, z](auto tag) -> StmtClosure {
+                    return [x, y, z](Value* s) { s[x] = arithmetic<decltype(tag)::value>(s[y], s[z]); };
+                });
+            }
+
+            return [x, e = compile_aexp(assign.aexp_.get())](Value* s) { s[x] = e(s); };
+        }
+    };
+
+    return std::visit(visitor, *assign.aexp_);
+}
+
+AExpClosure ClosureProgram::compile_aexp(const AExp* aexp) const {
+    if (!aexp) throw std::invalid_argument("Given AExp is empty!");
+
+    auto visitor = overload {
+        [this](const Var& var) -> AExpClosure {
+            const auto y = slots_.at(var.name_);
+            return [y](const Value* s) { return s[y]; };
+        },
+        [](const Num& num) -> AExpClosure {
+            const Value c = num.val_;
+            return [c](const Value*) { return c; };
+        },
+        [this](const ArithmeticOp& opa) -> AExpClosure {
+            const auto op = interpreter::arithmetic_op_kind(opa.op_);
+            const auto* lhs_var = std::get_if<Var>(opa.lhs_.get());
+            const auto* rhs_num = std::get_if<Num>(opa.rhs_.get());
+
+            // (y op n)
+            if (lhs_var && rhs_num) {
+                const auto y = slots_.at(lhs_var->name_);
+                const Value c = rhs_num->val_;
+                return with_op(op, [y, c](auto tag) -> AExpClosure {
+                    return [y, c](const Value* s) { return arithmetic<decltype(tag)::value>(s[y], c); };
+                });
+            }
+
+            return with_op(op, [lhs = compile_aexp(opa.lhs_.get()), rhs = compile_aexp(opa.rhs_.get())](auto tag) -> AExpClosure {
+                return [lhs, rhs](const Value* s) { return arithmetic<decltype(tag)::value>(lhs(s), rhs(s)); };
+            });
+        }
+    };
+
+    return std::visit(visitor, *aexp);
+}
+
+BExpClosure ClosureProgram::compile_bexp(const BExp* bexp) const {
+    if (!bexp) throw std::invalid_argument("Given BExp is empty!");
+
+    auto visitor = overload {
+        [](const True&) -> BExpClosure {
+            return [](const Value*) { return true; };
+        },
+        [](const False&) -> BExpClosure {
+            return [](const Value*) { return false; };
+        },
+        [this](const Not& n) -> BExpClosure {
+            return [b = compile_bexp(n.b_.get())](const Value* s) { return !b(s); };
+        },
+        [this](const BooleanOp& opb) -> BExpClosure {
+            auto lhs = compile_bexp(opb.lhs_.get());
+            auto rhs = compile_bexp(opb.rhs_.get());
+
+            if (interpreter::boolean_op_kind(opb.op_) == BooleanOpKind::And) {
+                return [lhs, rhs](const Value* s) { return lhs(s) && rhs(s); };
+            }
+            return [lhs, rhs](const Value* s) { return lhs(s) || rhs(s); };
+        },
+        [this](const RelationalOp& opr) -> BExpClosure {
+            return compile_relational(opr);
+        }
+    };
+
+    return std::visit(visitor, *bexp);
+}
+
+BExpClosure ClosureProgram::compile_relational(const RelationalOp& opr) const {
+    const auto op = interpreter::relational_op_kind(opr.op_);
+    const auto* lhs_var = std::get_if<Var>(opr.lhs_.get());
+    const auto* rhs_var = std::get_if<Var>(opr.rhs_.get());
+    const auto* rhs_num = std::get_if<Num>(opr.rhs_.get());
+
+    // (x opr n)
+    if (lhs_var && rhs_num) {
+        const auto x = slots_.at(lhs_var->name_);
+        const Value c = rhs_num->val_;
+        return with_op(op, [x, c](auto tag) -> BExpClosure {
+            return [x, c](const Value* s) { return relational<decltype(tag)::value>(s[x], c); };
+        });
+    }
+
+    // (x opr y)
+    if (lhs_var && rhs_var) {
+        const auto x = slots_.at(lhs_var->name_);
+        const auto y = slots_.at(rhs_var->name_);
+        return with_op(op, [x, y](auto tag) -> BExpClosure {
+            return [x, y](const Value* s) { return relational<decltype(tag)::value>(s[x], s[y]); };
+        });
+    }
+
+    return with_op(op, [lhs = compile_aexp(opr.lhs_.get()), rhs = compile_aexp(opr.rhs_.get())](auto tag) -> BExpClosure {
+        return [lhs, rhs](const Value* s) { return relational<decltype(tag)::value>(lhs(s), rhs(s)); };
+    });
+}
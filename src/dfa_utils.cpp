@@ -1,12 +1,18 @@
 #include "dfa_utils.hpp"
 
+#include <limits>
+#include <map>
+#include <unordered_map>
+
+#include "analysis_memory.hpp"
+
 
 // dfa_utils
 
 FreeVariables dfa_utils::free_variables_aexp(const AExp* aexp) {
     if (!aexp) throw std::invalid_argument("Given AExp is empty!");
 
-    FreeVariables free_vars{};
+    FreeVariables free_vars{analysis_memory::resource()};
 
     auto visitor = overload {
       [&free_vars](const Var& var) { 
@@ -29,7 +35,7 @@ FreeVariables dfa_utils::free_variables_aexp(const AExp* aexp) {
 FreeVariables dfa_utils::free_variables_bexp(const BExp* bexp) {
     if (!bexp) throw std::invalid_argument("Given BExp is empty!");
 
-    FreeVariables free_vars;
+    FreeVariables free_vars{analysis_memory::resource()};
 
     auto visitor = overload {
         [&free_vars](const True& t) {},
@@ -60,7 +66,7 @@ FreeVariables dfa_utils::free_variables_bexp(const BExp* bexp) {
 FreeVariables dfa_utils::free_variables_stmt(const Stmt* stmt) {
     if (!stmt) throw std::invalid_argument("Given Stmt is empty!");
 
-    FreeVariables free_vars{};
+    FreeVariables free_vars{analysis_memory::resource()};
 
     auto visitor = overload {
         [&free_vars](const Skip& s) {},
@@ -96,10 +102,10 @@ FreeVariables dfa_utils::free_variables_stmt(const Stmt* stmt) {
     return free_vars;
 }
 
-std::set<PP> dfa_utils::program_points(const Stmt* stmt) {
+ProgramPoints dfa_utils::program_points(const Stmt* stmt) {
     if (!stmt) throw std::invalid_argument("Given Stmt is empty!");
 
-    std::set<PP> pps{};
+    ProgramPoints pps{analysis_memory::resource()};
 
     auto visitor = overload {
         [&pps](const Skip& s) {
@@ -150,12 +156,12 @@ const Block* dfa_utils::get_block(const Stmt* stmt, const PP pp) {
                 return cond_ptr;
             }
 
-            std::set<PP> pps_then = program_points(i.then_.get());
+            ProgramPoints pps_then = program_points(i.then_.get());
             if (pps_then.contains(pp)) {
                 return get_block(i.then_.get(), pp);
             }
 
-            std::set<PP> pps_else = program_points(i.else_.get());
+            ProgramPoints pps_else = program_points(i.else_.get());
             if (pps_else.contains(pp)) {
                 return get_block(i.else_.get(), pp);
             }
@@ -168,7 +174,7 @@ const Block* dfa_utils::get_block(const Stmt* stmt, const PP pp) {
                 return cond_ptr;
             }
 
-            std::set<PP> pps_body = program_points(w.body_.get());
+            ProgramPoints pps_body = program_points(w.body_.get());
             if (pps_body.contains(pp)) {
                 return get_block(w.body_.get(), pp);
             }
@@ -176,12 +182,12 @@ const Block* dfa_utils::get_block(const Stmt* stmt, const PP pp) {
             return nullptr;
         },
         [&pp](const SeqComp& sc) -> const Block* {
-            std::set<PP> pps_fst = program_points(sc.fst_.get());
+            ProgramPoints pps_fst = program_points(sc.fst_.get());
             if (pps_fst.contains(pp)) {
                 return get_block(sc.fst_.get(), pp);
             }
 
-            std::set<PP> pps_snd = program_points(sc.snd_.get());
+            ProgramPoints pps_snd = program_points(sc.snd_.get());
             if (pps_snd.contains(pp)) {
                 return get_block(sc.snd_.get(), pp);
             }
@@ -196,7 +202,7 @@ const Block* dfa_utils::get_block(const Stmt* stmt, const PP pp) {
 ElementaryBlocks dfa_utils::blocks(const Stmt* stmt) {
     if (!stmt) throw std::invalid_argument("Given Stmt is empty!");
 
-    ElementaryBlocks bs{};
+    ElementaryBlocks bs{analysis_memory::resource()};
 
     auto visitor = overload {
         [&bs](const Skip& s) {
@@ -348,10 +354,10 @@ bool dfa_utils::is_initial_pp(const Stmt* stmt, const PP pp) {
     return pp == initial_pp(stmt);
 }
 
-std::set<PP> dfa_utils::final_pps(const Stmt* stmt) {
+ProgramPoints dfa_utils::final_pps(const Stmt* stmt) {
     if (!stmt) throw std::invalid_argument("Given Stmt is empty!");
 
-    std::set<PP> pps{};
+    ProgramPoints pps{analysis_memory::resource()};
 
     auto visitor = overload {
         [&pps](const Skip& s) {
@@ -393,7 +399,7 @@ bool dfa_utils::is_final_pp(const Stmt* stmt, const PP pp) {
 CFG dfa_utils::control_flow(const Stmt* stmt) {
     if (!stmt) throw std::invalid_argument("Given Stmt is empty!");
 
-    CFG cf{};
+    CFG cf{analysis_memory::resource()};
 
     auto visitor = overload {
         [&cf](const Skip& s) {},
@@ -417,7 +423,7 @@ CFG dfa_utils::control_flow(const Stmt* stmt) {
             auto final_pp_body = final_pps(w.body_.get());
 
             
-            CFG cross_pp_final_body{};
+            CFG cross_pp_final_body{analysis_memory::resource()};
             for(const auto& final_pp: final_pp_body) {
                 cross_pp_final_body.insert(std::make_pair(final_pp, w.cond_->pp_));
             }
@@ -433,7 +439,7 @@ CFG dfa_utils::control_flow(const Stmt* stmt) {
             auto final_pp_fst = final_pps(sc.fst_.get());
             auto initial_pp_snd = initial_pp(sc.snd_.get());
 
-            CFG cross_final_fst_init_snd{};
+            CFG cross_final_fst_init_snd{analysis_memory::resource()};
             for(const auto& final_pp: final_pp_fst) {
                 cross_final_fst_init_snd.insert(std::make_pair(final_pp, initial_pp_snd));
             }
@@ -449,6 +455,12 @@ CFG dfa_utils::control_flow(const Stmt* stmt) {
     return cf;
 }
 
+ProgramInfo dfa_utils::program_info(const Stmt* stmt) {
+    if (!stmt) throw std::invalid_argument("Given Stmt is empty!");
+
+    return { program_points(stmt), control_flow(stmt), final_pps(stmt) };
+}
+
 bool dfa_utils::has_isolated_entries(const Stmt* stmt)
 {
     if (!stmt) throw std::invalid_argument("Given Stmt is empty!");
@@ -482,6 +494,244 @@ bool dfa_utils::has_isolated_exits(const Stmt* stmt)
     return true;
 }
 
+std::vector<std::vector<PP>> dfa_utils::strongly_connected_components(const ProgramPoints& pps, const CFG& cf) {
+    // Dense indices for the program points, then adjacency lists
+    const std::vector<PP> nodes{pps.begin(), pps.end()};
+    std::unordered_map<PP, unsigned int> index_of{};
+    for (unsigned int i = 0; i < nodes.size(); ++i) index_of.emplace(nodes[i], i);
+
+    std::vector<std::vector<unsigned int>> succ(nodes.size());
+    for (const auto& [from, to]: cf) {
+        auto from_it = index_of.find(from);
+        auto to_it = index_of.find(to);
+        if (from_it != index_of.end() && to_it != index_of.end()) succ[from_it->second].push_back(to_it->second);
+    }
+
+    constexpr unsigned int unvisited = std::numeric_limits<unsigned int>::max();
+    std::vector<unsigned int> index(nodes.size(), unvisited);
+    std::vector<unsigned int> lowlink(nodes.size(), 0);
+    std::vector<bool> on_stack(nodes.size(), false);
+    std::vector<unsigned int> stack{};
+    unsigned int next_index = 0;
+
+    std::vector<std::vector<PP>> components{};
+
+    // Iterative, nested loops in large programs would otherwise exhaust the call stack
+    std::vector<std::pair<unsigned int, std::size_t>> call_stack{};   // Node and next edge to visit
+    for (unsigned int root = 0; root < nodes.size(); ++root) {
+        if (index[root] != unvisited) continue;
+
+        call_stack.emplace_back(root, 0);
+        while (!call_stack.empty()) {
+            auto& [v, edge] = call_stack.back();
+
+            if (edge == 0) {
+                index[v] = lowlink[v] = next_index++;
+                stack.push_back(v);
+                on_stack[v] = true;
+            }
+
+            if (edge < succ[v].size()) {
+                const unsigned int w = succ[v][edge++];
+                if (index[w] == unvisited) call_stack.emplace_back(w, 0);
+                else if (on_stack[w]) lowlink[v] = std::min(lowlink[v], index[w]);
+                continue;
+            }
+
+            // All successors visited, v is the root of a component iff its lowlink is its own index
+            if (lowlink[v] == index[v]) {
+                std::vector<PP> component{};
+                unsigned int w;
+                do {
+                    w = stack.back();
+                    stack.pop_back();
+                    on_stack[w] = false;
+                    component.push_back(nodes[w]);
+                } while (w != v);
+                components.push_back(std::move(component));
+            }
+
+            const unsigned int finished = v;
+            call_stack.pop_back();
+            if (!call_stack.empty()) {
+                const unsigned int parent = call_stack.back().first;
+                lowlink[parent] = std::min(lowlink[parent], lowlink[finished]);
+            }
+        }
+    }
+
+    return components;
+}
+
+namespace {
+    // Bourdoncle, "Efficient chaotic iteration strategies with widenings", 1993
+    class WTOBuilder {
+    public:
+        WTOBuilder(const ProgramPoints& pps, const CFG& cf) {
+            for (const auto pp: pps) {
+                succ_[pp];
+                dfn_[pp] = 0;
+            }
+            for (const auto& [from, to]: cf) {
+                if (succ_.contains(from) && succ_.contains(to)) succ_[from].push_back(to);
+            }
+        }
+
+        void visit_root(PP root, WTO& partition) {
+            if (dfn_.at(root) != 0) return;
+            visit(root, partition);
+        }
+
+    private:
+        static constexpr unsigned int infinity = std::numeric_limits<unsigned int>::max();
+
+        // A call of visit, or of component once the search found v to be the head of a loop
+        struct Frame {
+            PP v_;
+            std::size_t edge_;              // Next successor to visit
+            unsigned int head_;
+            bool loop_;
+            bool component_;
+            WTO partition_;                 // Of the component
+        };
+
+        std::map<PP, std::vector<PP>> succ_;
+        std::map<PP, unsigned int> dfn_;
+        std::vector<PP> stack_;
+        unsigned int num_{0};
+
+        // Iterative like the Tarjan search above, one frame per program point on the current path.
+        // The paper prepends to the partition, here elements are appended and the owner of the partition
+        // reverses it once it is complete
+        void visit(PP root, WTO& root_partition) {
+            std::vector<Frame> frames{};
+            std::vector<std::size_t> components{};      // Frames whose partition is being filled
+            const auto partition = [&]() -> WTO& {
+                return components.empty() ? root_partition : frames[components.back()].partition_;
+            };
+            const auto call = [&](PP v) {
+                stack_.push_back(v);
+                dfn_[v] = ++num_;
+                frames.push_back({v, 0, dfn_[v], false, false, {}});
+            };
+
+            call(root);
+            while (!frames.empty()) {
+                const std::size_t f = frames.size() - 1;
+                const PP v = frames[f].v_;
+                const auto& succ = succ_[v];
+
+                if (frames[f].edge_ < succ.size()) {
+                    const PP w = succ[frames[f].edge_++];
+                    if (dfn_[w] == 0) call(w);
+                    else if (!frames[f].component_ && dfn_[w] <= frames[f].head_) {
+                        frames[f].head_ = dfn_[w];
+                        frames[f].loop_ = true;
+                    }
+                    continue;
+                }
+
+                if (frames[f].component_) {
+                    components.pop_back();
+                    std::reverse(frames[f].partition_.begin(), frames[f].partition_.end());
+                    partition().push_back({v, std::move(frames[f].partition_), true});
+                }
+                else if (frames[f].head_ == dfn_[v]) {
+                    dfn_[v] = infinity;
+                    PP element = stack_.back();
+                    stack_.pop_back();
+
+                    if (frames[f].loop_) {
+                        while (element != v) {
+                            dfn_[element] = 0;
+                            element = stack_.back();
+                            stack_.pop_back();
+                        }
+
+                        // Continue as component(v), its head is returned once the component is complete
+                        frames[f].edge_ = 0;
+                        frames[f].component_ = true;
+                        components.push_back(f);
+                        continue;
+                    }
+                    partition().push_back(WTOElement{v, {}, false});
+                }
+
+                // Return the head to the calling visit, component ignores it
+                const unsigned int head = frames[f].head_;
+                frames.pop_back();
+                if (!frames.empty() && !frames.back().component_ && head <= frames.back().head_) {
+                    frames.back().head_ = head;
+                    frames.back().loop_ = true;
+                }
+            }
+        }
+    };
+}
+
+WTO dfa_utils::weak_topological_order(const ProgramPoints& pps, const CFG& cf, const ProgramPoints& roots) {
+    WTOBuilder builder{pps, cf};
+
+    // One partition for all roots, a later search may reach program points of an earlier one but not vice versa
+    WTO order{};
+    for (const auto root: roots) builder.visit_root(root, order);
+    for (const auto pp: pps) builder.visit_root(pp, order);
+    std::reverse(order.begin(), order.end());
+
+    return order;
+}
+
+CFG dfa_utils::reverse_flow(const CFG& cf) {
+    CFG reversed{analysis_memory::resource()};
+    for (const auto& [from, to]: cf) reversed.emplace(to, from);
+
+    return reversed;
+}
+
+std::vector<std::vector<PP>> dfa_utils::basic_blocks(const ProgramPoints& pps, const CFG& cf) {
+    std::map<PP, std::vector<PP>> succ{}, pred{};
+    for (const auto pp: pps) {
+        succ[pp];
+        pred[pp];
+    }
+    for (const auto& [from, to]: cf) {
+        if (succ.contains(from) && succ.contains(to)) {
+            succ[from].push_back(to);
+            pred[to].push_back(from);
+        }
+    }
+
+    // The next program point continues the block iff it is the only successor and this is its only predecessor
+    const auto continues = [&](PP pp) {
+        return succ[pp].size() == 1 && pred[succ[pp].front()].size() == 1 && succ[pp].front() != pp;
+    };
+
+    std::vector<std::vector<PP>> blocks{};
+    ProgramPoints visited{analysis_memory::resource()};
+    const auto collect = [&](PP leader) {
+        std::vector<PP> block{ leader };
+        visited.insert(leader);
+        while (continues(block.back()) && !visited.contains(succ[block.back()].front())) {
+            block.push_back(succ[block.back()].front());
+            visited.insert(block.back());
+        }
+        blocks.push_back(std::move(block));
+    };
+
+    for (const auto pp: pps) {
+        const auto& p = pred[pp];
+        if (p.size() != 1 || !continues(p.front())) collect(pp);
+    }
+
+    // What is left are cycles of straight-line code, any program point of them can lead
+    for (const auto pp: pps) {
+        if (!visited.contains(pp)) collect(pp);
+    }
+
+    std::sort(blocks.begin(), blocks.end());
+    return blocks;
+}
+
 
 // dfa_utils::io
 
@@ -496,7 +746,7 @@ void dfa_utils::io::print_var_set(const FreeVariables& vars) {
     std::cout << " }\n";
 }
 
-void dfa_utils::io::print_pp_set(const std::set<PP>& pps) {
+void dfa_utils::io::print_pp_set(const ProgramPoints& pps) {
     std::cout << "Program points: { ";
     for (auto it = pps.cbegin(); it != pps.cend(); ++it) {
         std::cout << *it;
@@ -513,21 +763,31 @@ void dfa_utils::io::print_block_set(const ElementaryBlocks& blocks) {
     for (auto it = blocks.cbegin(); it != blocks.cend(); ++it) {
         auto b = *it;
 
-        if (auto skip_block = dynamic_cast<const Skip*>(b)) {
-            printer.print(*skip_block);
-        } else if (auto assign_block = dynamic_cast<const Assign*>(b)) {
-            std::cout << "[";
-            printer.print(*(assign_block->var_));
-            std::cout << " := ";
-            printer.print(*(assign_block->aexp_));
-            std::cout << "]^";
-            std::cout << assign_block->pp_;
-        
-        } else if (auto cond_block = dynamic_cast<const Cond*>(b)) {
-            std::cout << "[";
-            printer.print(*(cond_block->bexp_));
-            std::cout << "]^";
-            std::cout << cond_block->pp_;
+        // get_block yields no block for program points the program does not have, printed as nothing
+        if (b) {
+            switch (b->kind_) {
+                case BlockKind::Skip:
+                    printer.print(*static_cast<const Skip*>(b));
+                    break;
+                case BlockKind::Assign: {
+                    const auto assign_block = static_cast<const Assign*>(b);
+                    std::cout << "[";
+                    printer.print(*(assign_block->var_));
+                    std::cout << " := ";
+                    printer.print(*(assign_block->aexp_));
+                    std::cout << "]^";
+                    std::cout << assign_block->pp_;
+                    break;
+                }
+                case BlockKind::Cond: {
+                    const auto cond_block = static_cast<const Cond*>(b);
+                    std::cout << "[";
+                    printer.print(*(cond_block->bexp_));
+                    std::cout << "]^";
+                    std::cout << cond_block->pp_;
+                    break;
+                }
+            }
         }
 
         if (std::next(it) != blocks.end()) {
@@ -0,0 +1,81 @@
+#include "incremental.hpp"
+
+#include "lexer.hpp"
+#include "parser.hpp"
+
+
+IncrementalLV::IncrementalLV(std::unique_ptr<Stmt> program):
+    program_{std::move(program)}, lv_{program_.get()}
+{
+    unsigned int iterations = 0;
+    vec_ = lv_.compute_wto(iterations);
+    index(program_);
+}
+
+unsigned int IncrementalLV::apply(const Edit& edit) {
+    const PP pp = edit.pp_;
+    if (pp < 1 || pp > statements_.size()) throw std::runtime_error("Invalid mapping index!");
+
+    Lexer lexer{edit.text_};
+    Parser parser{lexer.tokenize()};
+
+    if (auto* slot = conditions_[pp - 1]) {
+        auto cond = parser.parse_single_condition();
+        const unsigned int visits = lv_.replace_condition(pp, cond.get(), vec_);
+
+        retired_conditions_.push_back(std::exchange(*slot, std::move(cond)));
+        return visits;
+    }
+
+    auto* slot = statements_[pp - 1];
+    auto replacement = parser.parse();
+    const Stmt* program = slot == &program_ ? replacement.get() : program_.get();
+    const unsigned int visits = lv_.replace_block(program, pp, replacement.get(), vec_);
+
+    retired_statements_.push_back(std::exchange(*slot, std::move(replacement)));
+    index(*slot);
+    return visits;
+}
+
+void IncrementalLV::index(std::unique_ptr<Stmt>& slot) {
+    const auto record_statement = [this, &slot](PP pp) {
+        if (statements_.size() < pp) {
+            statements_.resize(pp, nullptr);
+            conditions_.resize(pp, nullptr);
+        }
+        statements_[pp - 1] = &slot;
+        conditions_[pp - 1] = nullptr;
+    };
+    const auto record_condition = [this](std::unique_ptr<Cond>& cond) {
+        if (statements_.size() < cond->pp_) {
+            statements_.resize(cond->pp_, nullptr);
+            conditions_.resize(cond->pp_, nullptr);
+        }
+        statements_[cond->pp_ - 1] = nullptr;
+        conditions_[cond->pp_ - 1] = &cond;
+    };
+
+    auto visitor = overload {
+        [&](Skip& s) {
+            record_statement(s.pp_);
+        },
+        [&](Assign& a) {
+            record_statement(a.pp_);
+        },
+        [&](If& i) {
+            record_condition(i.cond_);
+            index(i.then_);
+            index(i.else_);
+        },
+        [&](While& w) {
+            record_condition(w.cond_);
+            index(w.body_);
+        },
+        [&](SeqComp& sc) {
+            index(sc.fst_);
+            index(sc.snd_);
+        }
+    };
+
+    std::visit(visitor, *slot);
+}
@@ -0,0 +1,237 @@
+#include "incremental_parser.hpp"
+
+#include <algorithm>
+#include <string_view>
+
+#include "lexer.hpp"
+#include "utils.hpp"
+
+
+namespace {
+    using Slot = std::unique_ptr<Stmt>;
+
+    // Sequences nest to the right, s1; s2; s3 is SeqComp(s1, SeqComp(s2, s3)). The spine lists the slots of the
+    // SeqComp nodes and of the elements, a statement that is no sequence is its only element
+    struct Spine {
+        std::vector<Slot*> nodes_;
+        std::vector<Slot*> elements_;
+    };
+
+    Spine spine(Slot& slot) {
+        Spine s{};
+        Slot* current = &slot;
+        while (auto seq = std::get_if<SeqComp>(current->get())) {
+            s.nodes_.push_back(current);
+            s.elements_.push_back(&seq->fst_);
+            current = &seq->snd_;
+        }
+        s.elements_.push_back(current);
+
+        return s;
+    }
+
+    // Part of the program that is parsed again, a run of elements of the sequence in slot or the whole statement
+    struct Region {
+        Slot* slot_;
+        bool elements_;
+        std::size_t first_;
+        std::size_t last_;
+    };
+
+    // Statements of the subtree, iteratively since sequences nest as deep as they are long
+    std::vector<const Stmt*> statements(const Stmt* root) {
+        std::vector<const Stmt*> result{}, stack{ root };
+        while (!stack.empty()) {
+            const Stmt* stmt = stack.back();
+            stack.pop_back();
+            if (!stmt) continue;
+
+            result.push_back(stmt);
+            auto visitor = overload {
+                [](const Skip& s) {},
+                [](const Assign& a) {},
+                [&stack](const If& i) {
+                    stack.push_back(i.then_.get());
+                    stack.push_back(i.else_.get());
+                },
+                [&stack](const While& w) {
+                    stack.push_back(w.body_.get());
+                },
+                [&stack](const SeqComp& sc) {
+                    stack.push_back(sc.fst_.get());
+                    stack.push_back(sc.snd_.get());
+                }
+            };
+            std::visit(visitor, *stmt);
+        }
+
+        return result;
+    }
+}
+
+
+IncrementalParser::IncrementalParser(std::string text): text_{std::move(text)} {
+    Lexer lexer{borrowed_text, text_};
+    tokens_ = lexer.tokenize(offsets_);
+
+    Parser parser{tokens_};
+    program_ = parser.parse(spans_);
+}
+
+ReparseStats IncrementalParser::apply(const TextEdit& edit) {
+    if (edit.offset_ + edit.length_ > text_.size()) throw std::runtime_error("Edit out of range!");
+
+    std::string text = text_.substr(0, edit.offset_) + edit.text_ + text_.substr(edit.offset_ + edit.length_);
+    const long char_delta = static_cast<long>(edit.text_.size()) - static_cast<long>(edit.length_);
+    const std::size_t edit_end = edit.offset_ + edit.text_.size();
+
+    // Relex from the last token that starts before the edit, the edit may extend it
+    const std::size_t before = std::lower_bound(offsets_.begin(), offsets_.end(), edit.offset_) - offsets_.begin();
+    const std::size_t first = before > 0 ? before - 1 : 0;
+    const std::size_t relex_start = offsets_.empty() ? 0 : std::min(offsets_[first], edit.offset_);
+
+    // Behind the edit the text is unchanged, once a token starts where an old one did all further tokens agree
+    Lexer lexer{borrowed_text, text};
+    std::vector<Token> relexed{};
+    std::vector<std::size_t> relexed_offsets{};
+    std::size_t resync = tokens_.size();
+    std::size_t start = 0;
+    for (auto token = lexer.token_at(relex_start, start); token.first != TokenKind::EndOfFile;
+         token = lexer.token_at(lexer.position(), start)) {
+        if (start >= edit_end) {
+            const std::size_t old_start = start + edit.length_ - edit.text_.size();
+            const auto it = std::lower_bound(offsets_.begin() + first, offsets_.end(), old_start);
+            if (it != offsets_.end() && *it == old_start) {
+                resync = it - offsets_.begin();
+                break;
+            }
+        }
+        relexed.push_back(std::move(token));
+        relexed_offsets.push_back(start);
+    }
+
+    // Damaged old tokens [first, resync), e.g. edits of whitespace do not change any token
+    const std::size_t relexed_count = relexed.size();
+    if (relexed_count == resync - first && std::equal(relexed.begin(), relexed.end(), tokens_.begin() + first)) {
+        replace_tokens(first, resync, std::move(relexed), relexed_offsets, std::move(text), char_delta);
+        return { relexed_count, 0 };
+    }
+
+    const auto contains = [&](const Slot& slot) {
+        const auto [begin, end] = spans_.at(slot.get());
+        return begin <= first && resync <= end;
+    };
+
+    // Candidate regions from the whole program inwards
+    std::vector<Region> regions{ { &program_, false, 0, 0 } };
+    Slot* slot = &program_;
+    while (true) {
+        auto s = spine(*slot);
+        if (s.nodes_.empty()) {
+            Slot* child = nullptr;
+            if (auto i = std::get_if<If>(slot->get())) {
+                if (contains(i->then_)) child = &i->then_;
+                else if (contains(i->else_)) child = &i->else_;
+            } else if (auto w = std::get_if<While>(slot->get())) {
+                if (contains(w->body_)) child = &w->body_;
+            }
+            if (!child) break;
+
+            slot = child;
+            regions.push_back({ slot, false, 0, 0 });
+            continue;
+        }
+
+        // Elements from the one the damage starts in to the one it ends in, separators in between included
+        std::size_t k = s.elements_.size(), m = s.elements_.size();
+        for (std::size_t t = 0; t < s.elements_.size() && spans_.at(s.elements_[t]->get()).first <= first; ++t) k = t;
+        for (std::size_t t = k; t < s.elements_.size(); ++t) {
+            if (spans_.at(s.elements_[t]->get()).second >= resync) {
+                m = t;
+                break;
+            }
+        }
+        if (k == s.elements_.size() || m == s.elements_.size()) break;
+
+        regions.push_back({ slot, true, k, m });
+        if (k != m) break;
+        slot = s.elements_[k];
+    }
+
+    const long token_delta = static_cast<long>(relexed_count) - static_cast<long>(resync - first);
+    for (auto region = regions.rbegin(); region != regions.rend(); ++region) {
+        const bool is_program = region->slot_ == &program_ && !region->elements_;
+        auto s = spine(*region->slot_);
+
+        std::size_t begin = 0, end = tokens_.size();
+        if (region->elements_) {
+            begin = spans_.at(s.elements_[region->first_]->get()).first;
+            end = spans_.at(s.elements_[region->last_]->get()).second;
+        } else if (!is_program) {
+            std::tie(begin, end) = spans_.at(region->slot_->get());
+        }
+
+        std::vector<Token> tokens{ tokens_.begin() + begin, tokens_.begin() + first };
+        tokens.insert(tokens.end(), relexed.begin(), relexed.end());
+        tokens.insert(tokens.end(), tokens_.begin() + resync, tokens_.begin() + end);
+        const std::size_t reparsed = tokens.size();
+
+        Parser parser{std::move(tokens)};
+        StmtSpans spans{};
+        std::unique_ptr<Stmt> stmt{};
+        try {
+            stmt = parser.parse(spans);
+        } catch (const SyntaxError&) {
+            if (is_program) throw;
+            continue;
+        }
+        if (!is_program && !parser.at_end()) continue;
+
+        // The region parses, replace the old statements and move the spans behind the damage
+        const unsigned int sequence_end = spans_.at(region->slot_->get()).second + token_delta;
+        Slot* target = region->slot_;
+        Slot tail{};
+        if (region->elements_) {
+            target = region->first_ < s.nodes_.size() ? s.nodes_[region->first_] : s.elements_[region->first_];
+            if (region->last_ < s.nodes_.size()) tail = std::move(std::get<SeqComp>(**s.nodes_[region->last_]).snd_);
+        }
+
+        for (const auto old: statements(target->get())) spans_.erase(old);
+        for (auto& [old, span]: spans_) {
+            if (span.first >= resync) span.first += token_delta;
+            if (span.second >= resync) span.second += token_delta;
+        }
+        for (const auto& [parsed, span]: spans) spans_.emplace(parsed, std::make_pair(span.first + begin, span.second + begin));
+
+        // Elements after the region follow the last new element
+        if (tail) {
+            Slot* last = &stmt;
+            while (auto seq = std::get_if<SeqComp>(last->get())) {
+                spans_.at(last->get()).second = sequence_end;
+                last = &seq->snd_;
+            }
+
+            const unsigned int last_begin = spans_.at(last->get()).first;
+            *last = std::make_unique<Stmt>(SeqComp{ std::move(*last), std::move(tail) });
+            spans_.emplace(last->get(), std::make_pair(last_begin, sequence_end));
+        }
+        *target = std::move(stmt);
+
+        replace_tokens(first, resync, std::move(relexed), relexed_offsets, std::move(text), char_delta);
+        return { relexed_count, reparsed };
+    }
+
+    throw SyntaxError("Cannot parse edited program!");
+}
+
+void IncrementalParser::replace_tokens(std::size_t begin, std::size_t end, std::vector<Token> tokens,
+                                       const std::vector<std::size_t>& offsets, std::string text, long char_delta) {
+    tokens_.erase(tokens_.begin() + begin, tokens_.begin() + end);
+    tokens_.insert(tokens_.begin() + begin, std::make_move_iterator(tokens.begin()), std::make_move_iterator(tokens.end()));
+
+    offsets_.erase(offsets_.begin() + begin, offsets_.begin() + end);
+    offsets_.insert(offsets_.begin() + begin, offsets.begin(), offsets.end());
+    for (auto i = begin + offsets.size(); i < offsets_.size(); ++i) offsets_[i] += char_delta;
+
+    text_ = std::move(text);
+}
@@ -0,0 +1,165 @@
+#include "interpreter.hpp"
+#include "dfa_utils.hpp"
+
+
+// interpreter
+
+Value interpreter::eval_aexp(const AExp* aexp, const State& state) {
+    if (!aexp) throw std::invalid_argument("Given AExp is empty!");
+
+    auto visitor = overload {
+        [&state](const Var& var) -> Value {
+            auto it = state.find(var.name_);
+            return (it != state.end()) ? it->second : 0;
+        },
+        [](const Num& num) -> Value {
+            return num.val_;
+        },
+        [&state](const ArithmeticOp& opa) -> Value {
+            const auto lhs = eval_aexp(opa.lhs_.get(), state);
+            const auto rhs = eval_aexp(opa.rhs_.get(), state);
+            return apply(arithmetic_op_kind(opa.op_), lhs, rhs);
+        }
+    };
+
+    return std::visit(visitor, *aexp);
+}
+
+bool interpreter::eval_bexp(const BExp* bexp, const State& state) {
+    if (!bexp) throw std::invalid_argument("Given BExp is empty!");
+
+    auto visitor = overload {
+        [](const True& t) {
+            return true;
+        },
+        [](const False& f) {
+            return false;
+        },
+        [&state](const Not& n) {
+            return !eval_bexp(n.b_.get(), state);
+        },
+        [&state](const BooleanOp& opb) {
+            // Short-circuit evaluation, expressions have no side effects anyway
+            if (boolean_op_kind(opb.op_) == BooleanOpKind::And) {
+                return eval_bexp(opb.lhs_.get(), state) && eval_bexp(opb.rhs_.get(), state);
+            }
+            return eval_bexp(opb.lhs_.get(), state) || eval_bexp(opb.rhs_.get(), state);
+        },
+        [&state](const RelationalOp& opr) {
+            const auto lhs = eval_aexp(opr.lhs_.get(), state);
+            const auto rhs = eval_aexp(opr.rhs_.get(), state);
+            return apply(relational_op_kind(opr.op_), lhs, rhs);
+        }
+    };
+
+    return std::visit(visitor, *bexp);
+}
+
+void interpreter::exec_stmt(const Stmt* stmt, State& state) {
+    if (!stmt) throw std::invalid_argument("Given Stmt is empty!");
+
+    auto visitor = overload {
+        [](const Skip& s) {},
+        [&state](const Assign& a) {
+            state[a.var_->name_] = eval_aexp(a.aexp_.get(), state);
+        },
+        [&state](const If& i) {
+            if (eval_bexp(i.cond_->bexp_.get(), state)) {
+                exec_stmt(i.then_.get(), state);
+            } else {
+                exec_stmt(i.else_.get(), state);
+            }
+        },
+        [&state](const While& w) {
+            while (eval_bexp(w.cond_->bexp_.get(), state)) {
+                exec_stmt(w.body_.get(), state);
+            }
+        },
+        [&state](const SeqComp& sc) {
+            exec_stmt(sc.fst_.get(), state);
+            exec_stmt(sc.snd_.get(), state);
+        }
+    };
+
+    std::visit(visitor, *stmt);
+}
+
+ArithmeticOpKind interpreter::arithmetic_op_kind(const std::string& op) {
+    if (op == "+") return ArithmeticOpKind::Add;
+    if (op == "-") return ArithmeticOpKind::Sub;
+    if (op == "*") return ArithmeticOpKind::Mul;
+
+    throw std::runtime_error("Unknown arithmetic operator " + op + "!");
+}
+
+RelationalOpKind interpreter::relational_op_kind(const std::string& op) {
+    if (op == "<") return RelationalOpKind::Lt;
+    if (op == "<=") return RelationalOpKind::Le;
+    if (op == ">") return RelationalOpKind::Gt;
+    if (op == ">=") return RelationalOpKind::Ge;
+
+    throw std::runtime_error("Unknown relational operator " + op + "!");
+}
+
+BooleanOpKind interpreter::boolean_op_kind(const std::string& op) {
+    if (op == "and" || op == "&&") return BooleanOpKind::And;
+    if (op == "or" || op == "||") return BooleanOpKind::Or;
+
+    throw std::runtime_error("Unknown boolean operator " + op + "!");
+}
+
+Value interpreter::apply(ArithmeticOpKind op, Value lhs, Value rhs) {
+    // Compute on unsigned values so that overflow wraps around instead of being undefined
+    const auto l = static_cast<std::uint64_t>(lhs);
+    const auto r = static_cast<std::uint64_t>(rhs);
+
+    switch (op) {
+        case ArithmeticOpKind::Add: return static_cast<Value>(l + r);
+        case ArithmeticOpKind::Sub: return static_cast<Value>(l - r);
+        case ArithmeticOpKind::Mul: return static_cast<Value>(l * r);
+    }
+
+    throw std::runtime_error("Unknown arithmetic operator!");
+}
+
+bool interpreter::apply(RelationalOpKind op, Value lhs, Value rhs) {
+    switch (op) {
+        case RelationalOpKind::Lt: return lhs < rhs;
+        case RelationalOpKind::Le: return lhs <= rhs;
+        case RelationalOpKind::Gt: return lhs > rhs;
+        case RelationalOpKind::Ge: return lhs >= rhs;
+    }
+
+    throw std::runtime_error("Unknown relational operator!");
+}
+
+VarSlots interpreter::var_slots(const Stmt* stmt) {
+    VarSlots slots{};
+
+    for (const Var* var: dfa_utils::free_variables_stmt(stmt)) {
+        slots.emplace(var->name_, slots.size());
+    }
+
+    return slots;
+}
+
+std::vector<Value> interpreter::to_slots(const State& state, const VarSlots& slots) {
+    std::vector<Value> values(slots.size(), 0);
+
+    for (const auto& [name, slot]: slots) {
+        auto it = state.find(name);
+        if (it != state.end()) values[slot] = it->second;
+    }
+
+    return values;
+}
+
+State interpreter::from_slots(const std::vector<Value>& values, const VarSlots& slots) {
+    State state{};
+
+    for (const auto& [name, slot]: slots) {
+        state[name] = values.at(slot);
+    }
+
+    return state;
+}
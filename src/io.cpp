@@ -0,0 +1,50 @@
+#include "io.hpp"
+
+#include <iterator>
+
+#if __has_include(<sys/mman.h>)
+#define SDPA_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+ProgramSource::ProgramSource(const std::filesystem::path& path):
+    mapping_{nullptr}, mapping_size_{0}
+{
+#ifdef SDPA_MMAP
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) throw std::runtime_error("Error while opening file!");
+
+    struct stat st{};
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void* mapping = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            // The lexer reads front to back once, let the kernel read ahead aggressively
+            madvise(mapping, static_cast<std::size_t>(st.st_size), MADV_SEQUENTIAL);
+
+            mapping_ = mapping;
+            mapping_size_ = static_cast<std::size_t>(st.st_size);
+            text_ = std::string_view{static_cast<const char*>(mapping), mapping_size_};
+        }
+    }
+    close(fd);
+
+    if (mapping_) return;
+#endif
+
+    // Not through WLangReader, binary ASTs are mapped as well
+    std::ifstream file{path, std::ios::binary};
+    if (!file.is_open()) throw std::runtime_error("Error while opening file!");
+
+    owned_.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+    text_ = owned_;
+}
+
+ProgramSource::~ProgramSource() {
+#ifdef SDPA_MMAP
+    if (mapping_) munmap(mapping_, mapping_size_);
+#endif
+}
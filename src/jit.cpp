@@ -0,0 +1,368 @@
+#include "jit.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__x86_64__) && defined(__linux__)
+#define SDPA_JIT_X86_64 1
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+
+namespace {
+    // x86-64 register numbers as used in the ModRM/REX encoding
+    enum Reg : std::uint8_t {
+        RAX = 0, RCX = 1, RBX = 3, RDI = 7,
+        R12 = 12, R13 = 13, R14 = 14, R15 = 15
+    };
+
+    // Callee-saved registers that hold variables of small programs
+    constexpr Reg VAR_REGS[] = { RBX, R12, R13, R14, R15 };
+    constexpr std::size_t MAX_VAR_REGS = sizeof(VAR_REGS) / sizeof(VAR_REGS[0]);
+
+    // Condition codes of jcc, the negation of a condition code flips its lowest bit
+    enum CondCode : std::uint8_t { CC_L = 0xC, CC_GE = 0xD, CC_LE = 0xE, CC_G = 0xF };
+
+    struct Label {
+        std::int64_t pos = -1;
+        std::vector<std::size_t> fixups{};
+    };
+
+    /**
+     * Emits machine code for a statement by concatenating a fixed template per AST node.
+     * Expressions are evaluated into rax (and rcx for right operands), rdi holds the slot array.
+     */
+    class CodeGen {
+    public:
+        explicit CodeGen(const VarSlots& slots):
+            slots_{slots}, in_regs_{slots.size() <= MAX_VAR_REGS} {}
+
+        std::vector<std::uint8_t> compile(const Stmt* stmt) {
+            prologue();
+            emit_stmt(stmt);
+            epilogue();
+            resolve_labels();
+
+            return std::move(code_);
+        }
+
+    private:
+        const VarSlots& slots_;
+        const bool in_regs_;
+        std::vector<std::uint8_t> code_{};
+        std::vector<Label> labels_{};
+
+        // Encoding helpers
+
+        void byte(std::uint8_t b) {
+            code_.push_back(b);
+        }
+
+        void imm32(std::uint32_t v) {
+            for (int i = 0; i < 4; ++i) byte(static_cast<std::uint8_t>(v >> (8 * i)));
+        }
+
+        void rex_w(std::uint8_t reg, std::uint8_t rm) {
+            byte(0x48 | ((reg >> 3) << 2) | (rm >> 3));
+        }
+
+        void modrm(std::uint8_t mod, std::uint8_t reg, std::uint8_t rm) {
+            byte((mod << 6) | ((reg & 7) << 3) | (rm & 7));
+        }
+
+        void mov_rr(Reg dst, Reg src) {
+            rex_w(src, dst); byte(0x89); modrm(3, src, dst);
+        }
+
+        void load_slot(Reg dst, unsigned int slot) {
+            rex_w(dst, RDI); byte(0x8B); modrm(2, dst, RDI); imm32(8 * slot);
+        }
+
+        void store_slot(unsigned int slot, Reg src) {
+            rex_w(src, RDI); byte(0x89); modrm(2, src, RDI); imm32(8 * slot);
+        }
+
+        void mov_imm(Reg dst, std::uint32_t value) {
+            // mov r32, imm32 zero-extends into the full register
+            if (dst >= 8) byte(0x41);
+            byte(0xB8 + (dst & 7)); imm32(value);
+        }
+
+        void push(Reg r) {
+            if (r >= 8) byte(0x41);
+            byte(0x50 + (r & 7));
+        }
+
+        void pop(Reg r) {
+            if (r >= 8) byte(0x41);
+            byte(0x58 + (r & 7));
+        }
+
+        void arithmetic(ArithmeticOpKind op) {
+            // rax = rax op rcx
+            switch (op) {
+                case ArithmeticOpKind::Add: rex_w(RCX, RAX); byte(0x01); modrm(3, RCX, RAX); break;
+                case ArithmeticOpKind::Sub: rex_w(RCX, RAX); byte(0x29); modrm(3, RCX, RAX); break;
+                case ArithmeticOpKind::Mul: rex_w(RAX, RCX); byte(0x0F); byte(0xAF); modrm(3, RAX, RCX); break;
+            }
+        }
+
+        void cmp_rax_rcx() {
+            rex_w(RCX, RAX); byte(0x39); modrm(3, RCX, RAX);
+        }
+
+        unsigned int new_label() {
+            labels_.emplace_back();
+            return labels_.size() - 1;
+        }
+
+        void bind(unsigned int label) {
+            labels_[label].pos = static_cast<std::int64_t>(code_.size());
+        }
+
+        void jmp(unsigned int label) {
+            byte(0xE9);
+            labels_[label].fixups.push_back(code_.size());
+            imm32(0);
+        }
+
+        void jcc(std::uint8_t cc, unsigned int label) {
+            byte(0x0F); byte(0x80 + cc);
+            labels_[label].fixups.push_back(code_.size());
+            imm32(0);
+        }
+
+        void resolve_labels() {
+            for (const auto& label: labels_) {
+                for (const auto fixup: label.fixups) {
+                    const auto rel = static_cast<std::int32_t>(label.pos - static_cast<std::int64_t>(fixup + 4));
+                    std::memcpy(code_.data() + fixup, &rel, sizeof(rel));
+                }
+            }
+        }
+
+        // Function frame
+
+        void prologue() {
+            if (!in_regs_) return;
+
+            for (unsigned int slot = 0; slot < slots_.size(); ++slot) {
+                push(VAR_REGS[slot]);
+                load_slot(VAR_REGS[slot], slot);
+            }
+        }
+
+        void epilogue() {
+            if (in_regs_) {
+                for (unsigned int slot = 0; slot < slots_.size(); ++slot) {
+                    store_slot(slot, VAR_REGS[slot]);
+                }
+                for (auto slot = slots_.size(); slot-- > 0;) {
+                    pop(VAR_REGS[slot]);
+                }
+            }
+            byte(0xC3);
+        }
+
+        // AST templates
+
+        void emit_var(const Var& var, Reg dst) {
+            const auto slot = slots_.at(var.name_);
+            if (in_regs_) mov_rr(dst, VAR_REGS[slot]);
+            else load_slot(dst, slot);
+        }
+
+        static bool is_leaf(const AExp* aexp) {
+            return !std::holds_alternative<ArithmeticOp>(*aexp);
+        }
+
+        /*
+         * Evaluates both operands, lhs into rax and rhs into rcx.
+         */
+        void emit_operands(const AExp* lhs, const AExp* rhs) {
+            if (is_leaf(rhs)) {
+                emit_aexp(lhs, RAX);
+                emit_aexp(rhs, RCX);
+            } else {
+                emit_aexp(rhs, RAX);
+                push(RAX);
+                emit_aexp(lhs, RAX);
+                pop(RCX);
+            }
+        }
+
+        void emit_aexp(const AExp* aexp, Reg dst) {
+            auto visitor = overload {
+                [this, dst](const Var& var) {
+                    emit_var(var, dst);
+                },
+                [this, dst](const Num& num) {
+                    mov_imm(dst, num.val_);
+                },
+                [this, dst](const ArithmeticOp& opa) {
+                    emit_operands(opa.lhs_.get(), opa.rhs_.get());
+                    arithmetic(interpreter::arithmetic_op_kind(opa.op_));
+                    if (dst != RAX) mov_rr(dst, RAX);
+                }
+            };
+
+            std::visit(visitor, *aexp);
+        }
+
+        static CondCode cond_code(RelationalOpKind op) {
+            switch (op) {
+                case RelationalOpKind::Lt: return CC_L;
+                case RelationalOpKind::Le: return CC_LE;
+                case RelationalOpKind::Gt: return CC_G;
+                case RelationalOpKind::Ge: return CC_GE;
+            }
+            throw std::runtime_error("Unknown relational operator!");
+        }
+
+        /*
+         * Jumps to label iff the boolean expression evaluates to jump_if, falls through otherwise.
+         */
+        void emit_branch(const BExp* bexp, bool jump_if, unsigned int label) {
+            auto visitor = overload {
+                [this, jump_if, label](const True&) {
+                    if (jump_if) jmp(label);
+                },
+                [this, jump_if, label](const False&) {
+                    if (!jump_if) jmp(label);
+                },
+                [this, jump_if, label](const Not& n) {
+                    emit_branch(n.b_.get(), !jump_if, label);
+                },
+                [this, jump_if, label](const BooleanOp& opb) {
+                    // and: jumps if both true / if one false, or: jumps if one true / if both false
+                    const bool is_and = interpreter::boolean_op_kind(opb.op_) == BooleanOpKind::And;
+                    if (is_and != jump_if) {
+                        emit_branch(opb.lhs_.get(), jump_if, label);
+                        emit_branch(opb.rhs_.get(), jump_if, label);
+                    } else {
+                        const auto skip = new_label();
+                        emit_branch(opb.lhs_.get(), !jump_if, skip);
+                        emit_branch(opb.rhs_.get(), jump_if, label);
+                        bind(skip);
+                    }
+                },
+                [this, jump_if, label](const RelationalOp& opr) {
+                    emit_operands(opr.lhs_.get(), opr.rhs_.get());
+                    cmp_rax_rcx();
+                    const auto cc = cond_code(interpreter::relational_op_kind(opr.op_));
+                    jcc(jump_if ? cc : (cc ^ 1), label);
+                }
+            };
+
+            std::visit(visitor, *bexp);
+        }
+
+        void emit_stmt(const Stmt* stmt) {
+            auto visitor = overload {
+                [](const Skip&) {},
+                [this](const Assign& a) {
+                    const auto slot = slots_.at(a.var_->name_);
+                    if (in_regs_ && std::holds_alternative<Num>(*a.aexp_)) {
+                        mov_imm(VAR_REGS[slot], std::get<Num>(*a.aexp_).val_);
+                        return;
+                    }
+
+                    emit_aexp(a.aexp_.get(), RAX);
+                    if (in_regs_) mov_rr(VAR_REGS[slot], RAX);
+                    else store_slot(slot, RAX);
+                },
+                [this](const If& i) {
+                    const auto else_label = new_label();
+                    const auto end_label = new_label();
+                    emit_branch(i.cond_->bexp_.get(), false, else_label);
+                    emit_stmt(i.then_.get());
+                    jmp(end_label);
+                    bind(else_label);
+                    emit_stmt(i.else_.get());
+                    bind(end_label);
+                },
+                [this](const While& w) {
+                    const auto head_label = new_label();
+                    const auto exit_label = new_label();
+                    bind(head_label);
+                    emit_branch(w.cond_->bexp_.get(), false, exit_label);
+                    emit_stmt(w.body_.get());
+                    jmp(head_label);
+                    bind(exit_label);
+                },
+                [this](const SeqComp& sc) {
+                    emit_stmt(sc.fst_.get());
+                    emit_stmt(sc.snd_.get());
+                }
+            };
+
+            std::visit(visitor, *stmt);
+        }
+    };
+}
+
+
+JitProgram::JitProgram(const Stmt* stmt):
+    stmt_{stmt}, slots_{interpreter::var_slots(stmt)}, code_{nullptr}, code_size_{0}, fn_{nullptr}
+{
+    if (!host_supported()) return;
+
+    CodeGen codegen{slots_};
+    install(codegen.compile(stmt));
+}
+
+JitProgram::~JitProgram() {
+#ifdef SDPA_JIT_X86_64
+    if (code_) munmap(code_, code_size_);
+#endif
+}
+
+bool JitProgram::host_supported() {
+#ifdef SDPA_JIT_X86_64
+    return true;
+#else
+    return false;
+#endif
+}
+
+void JitProgram::install(const std::vector<std::uint8_t>& code) {
+#ifdef SDPA_JIT_X86_64
+    const auto page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    const auto size = (code.size() + page_size - 1) / page_size * page_size;
+
+    // Map writable first and flip to executable afterwards, W^X systems refuse RWX pages
+    void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) return;
+
+    std::memcpy(mem, code.data(), code.size());
+    if (mprotect(mem, size, PROT_READ | PROT_EXEC) != 0) {
+        munmap(mem, size);
+        return;
+    }
+
+    code_ = mem;
+    code_size_ = size;
+    fn_ = reinterpret_cast<CompiledFn>(mem);
+#endif
+}
+
+void JitProgram::run(Value* state) const {
+    if (fn_) {
+        fn_(state);
+        return;
+    }
+
+    // Fallback for hosts without native code generation
+    std::vector<Value> values(state, state + slots_.size());
+    auto named_state = interpreter::from_slots(values, slots_);
+    interpreter::exec_stmt(stmt_, named_state);
+    values = interpreter::to_slots(named_state, slots_);
+    std::copy(values.begin(), values.end(), state);
+}
+
+State JitProgram::run(const State& state) const {
+    auto values = interpreter::to_slots(state, slots_);
+    run(values.data());
+    return interpreter::from_slots(values, slots_);
+}
@@ -2,7 +2,10 @@
 
 
 Lexer::Lexer(std::string program_text) :
-    program_text_{std::move(program_text)}, position_{0} {}
+    owned_text_{std::move(program_text)}, program_text_{owned_text_}, position_{0} {}
+
+Lexer::Lexer(borrowed_text_t, std::string_view program_text) :
+    program_text_{program_text}, position_{0} {}
 
 void Lexer::advance() {
     ++position_;
@@ -13,7 +16,8 @@ void Lexer::skip_whitespace() {
         return;
     }
 
-    while (std::isspace(program_text_[position_])) {
+    // A borrowed text has no terminating null character, stay in bounds
+    while (has_next() && std::isspace(program_text_[position_])) {
         advance();
     }
 }
@@ -158,6 +162,29 @@ std::vector<Token> Lexer::tokenize() {
     return tokens;
 }
 
+std::vector<Token> Lexer::tokenize(std::vector<std::size_t>& offsets) {
+    std::vector<Token> tokens{};
+    offsets.clear();
+
+    std::size_t start = 0;
+    Token current_token = token_at(position_, start);
+    while (current_token.first != TokenKind::EndOfFile) {
+        tokens.push_back(current_token);
+        offsets.push_back(start);
+        current_token = token_at(position_, start);
+    }
+
+    return tokens;
+}
+
+Token Lexer::token_at(std::size_t offset, std::size_t& start) {
+    position_ = offset;
+    skip_whitespace();
+    start = position_;
+
+    return next_token();
+}
+
 
 void Lexer::print_tokens(const std::vector<Token>& tokens) const {
     std::cout << "==================== LEXER ====================\n";
@@ -1,65 +1,787 @@
 #include "lv.hpp"
 #include "dfa_utils.hpp"
 
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <queue>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+#include "summary_cache.hpp"
+#include "thread_pool.hpp"
+#include "var_sets.hpp"
+
 
 auto LiveVariableAnalysis::compute() const -> LiveVariablesVec {
+    unsigned int iteration = 0;
+    auto vec = compute(iteration);
+
+    std::cout << "LV-analysis in " << iteration << " iterations.\n";
+    return vec;
+}
+
+auto LiveVariableAnalysis::compute(unsigned int& iterations) const -> LiveVariablesVec {
+    // Iteration k is built in arena k % 2, the vector of iteration k - 2 is dropped before its arena is released
+    std::array<std::pmr::monotonic_buffer_resource, 2> arenas{};
+    std::array<std::optional<LiveVariablesVec>, 2> vecs{};
+
     // The vector holds #pp * 2 elements, for each pp entry and exit information
     const unsigned int vec_size = n_ * 2;
-    LiveVariablesVec vec(vec_size);
-    LiveVariablesVec prev_vec{vec};
+    vecs[0].emplace(vec_size, &arenas[0]);
 
     // Iterate until fixpoint reached
     unsigned int iteration = 1;
     while(true) {
-        vec = F_LV(vec);
+        const auto& prev_vec = *vecs[(iteration + 1) % 2];
+        auto& vec = vecs[iteration % 2];
+
+        vec.reset();
+        arenas[iteration % 2].release();
+        {
+            const analysis_memory::Scope scope{&arenas[iteration % 2]};
+            vec.emplace(F_LV(prev_vec));
+        }
 
-        if (fixpoint_reached(prev_vec, vec)) {
+        if (fixpoint_reached(prev_vec, *vec)) {
             break;
         }
 
-        prev_vec = vec;
         ++iteration;
     }
 
-    std::cout << "LV-analysis in " << iteration << " iterations.\n";
-    return vec;
+    iterations = iteration;
+
+    // Copies get the default resource
+    return LiveVariablesVec{*vecs[iteration % 2]};
+}
+
+auto LiveVariableAnalysis::compute(LVSolver solver, unsigned int& iterations, ThreadPool* pool) const -> LiveVariablesVec {
+    const bool parallel = solver == LVSolver::ParallelRoundRobin || solver == LVSolver::ParallelSCC;
+    if (parallel && !pool) throw std::invalid_argument("Parallel solver needs a thread pool!");
+
+    switch (solver) {
+        case LVSolver::RoundRobin: return compute(iterations);
+        case LVSolver::ParallelRoundRobin: return compute_parallel(*pool, iterations);
+        case LVSolver::SCC: return compute_scc(iterations);
+        case LVSolver::ParallelSCC: return compute_scc_parallel(*pool, iterations);
+        case LVSolver::WTO: return compute_wto(iterations);
+        case LVSolver::Structural: return compute_structural(iterations);
+        case LVSolver::Delta: return compute_delta(iterations);
+        case LVSolver::BasicBlocks: return compute_basic_blocks(iterations).materialize();
+        case LVSolver::HashConsed: return compute_hash_consed(iterations).materialize();
+        case LVSolver::Indexed: return compute_indexed(iterations);
+    }
+
+    throw std::runtime_error("Unknown solver!");
 }
 
 auto LiveVariableAnalysis::F_LV(const LiveVariablesVec& v) const -> LiveVariablesVec {
+    LiveVariablesVec vec(v.size(), analysis_memory::resource());
+    update(v, vec, 0, v.size() / 2);
+
+    return vec;
+}
+
+auto LiveVariableAnalysis::compute_parallel(ThreadPool& pool, unsigned int& iterations) const -> LiveVariablesVec {
+    LiveVariablesVec vec(n_ * 2);
+
+    // Iterate until fixpoint reached, the previous vector is moved instead of copied
+    unsigned int iteration = 1;
+    while(true) {
+        auto next = F_LV_parallel(vec, pool);
+
+        if (fixpoint_reached_parallel(vec, next, pool)) {
+            vec = std::move(next);
+            break;
+        }
+
+        vec = std::move(next);
+        ++iteration;
+    }
+
+    iterations = iteration;
+    return vec;
+}
+
+auto LiveVariableAnalysis::F_LV_parallel(const LiveVariablesVec& v, ThreadPool& pool) const -> LiveVariablesVec {
     LiveVariablesVec vec(v.size());
 
-    for (auto i = 0; i < v.size() / 2; ++i) {
-        const PP f_i = f(i);
+    const auto bounds = chunk_bounds(vec, pool.size());
+    pool.parallel_for(bounds.size() - 1, 1, [&](std::size_t begin, std::size_t end) {
+        for (auto c = begin; c < end; ++c) update(v, vec, bounds[c], bounds[c + 1]);
+    });
+
+    return vec;
+}
+
+void LiveVariableAnalysis::update(const LiveVariablesVec& v, LiveVariablesVec& vec, std::size_t begin, std::size_t end) const {
+    for (auto i = begin; i < end; ++i) {
+        const Transfer& transfer = transfers_[i];
 
         // vec[2*i]
-        const auto pp_block = dfa_utils::get_block(stmt_, f_i);
-        LiveVariables s = v[2*i + 1];
-        LiveVariables to_kill = kill_LV(pp_block);
-        LiveVariables to_gen = gen_LV(pp_block);
-        LiveVariables s_without_to_kill = var_ptr_set_difference(s, to_kill);
-        s_without_to_kill.merge(to_gen);
-        vec[2*i] = s_without_to_kill;
+        LiveVariables s_without_to_kill = var_ptr_set_difference(v[2*i + 1], transfer.kill_);
+        s_without_to_kill.insert(transfer.gen_.begin(), transfer.gen_.end());
+        vec[2*i] = std::move(s_without_to_kill);
 
         // vec[2*i + 1]
-        if (final_pps_.contains(f_i))
-            vec[2*i + 1] = {};
-        else {
-            LiveVariables union_entries_succ{};
-            for (const auto& edge: cf_) {
-                if (edge.first == f_i) {
-                    const PP f_j = edge.second;
-                    const PP j = f_j - 1;
-                    LiveVariables lvs = v[2*j];
-                    union_entries_succ.merge(lvs);
+        LiveVariables union_entries_succ{analysis_memory::resource()};
+        for (const auto j: successors_[i]) {
+            union_entries_succ.insert(v[2*j].begin(), v[2*j].end());
+        }
+        vec[2*i + 1] = std::move(union_entries_succ);
+    }
+}
+
+auto LiveVariableAnalysis::compute_scc(unsigned int& iterations) const -> LiveVariablesVec {
+    LiveVariablesVec vec(n_ * 2);
+
+    // Tarjan emits every component after the components reachable from it
+    iterations = 0;
+    for (const auto& component: dfa_utils::strongly_connected_components(pps_, cf_)) {
+        iterations = std::max(iterations, solve_component(component, vec));
+    }
+
+    return vec;
+}
+
+auto LiveVariableAnalysis::compute_scc_parallel(ThreadPool& pool, unsigned int& iterations) const -> LiveVariablesVec {
+    LiveVariablesVec vec(n_ * 2);
+    const auto components = dfa_utils::strongly_connected_components(pps_, cf_);
+
+    std::vector<unsigned int> component_of(n_);
+    for (unsigned int c = 0; c < components.size(); ++c) {
+        for (const auto pp: components[c]) component_of[pp - 1] = c;
+    }
+
+    // Edges of the condensation: a component can be solved once all of its successor components are
+    std::vector<std::set<unsigned int>> predecessors(components.size());
+    std::vector<std::atomic<unsigned int>> unsolved_successors(components.size());
+    for (unsigned int i = 0; i < n_; ++i) {
+        for (const auto j: successors_[i]) {
+            const unsigned int from = component_of[i], to = component_of[j];
+            if (from != to && predecessors[to].insert(from).second) ++unsolved_successors[from];
+        }
+    }
+
+    std::atomic<unsigned int> max_passes{0};
+    std::function<void(unsigned int)> solve = [&](unsigned int c) {
+        const unsigned int passes = solve_component(components[c], vec);
+
+        unsigned int max = max_passes.load(std::memory_order_relaxed);
+        while (passes > max && !max_passes.compare_exchange_weak(max, passes)) {}
+
+        // The counter orders the writes of this component before the reads of its predecessors
+        for (const auto p: predecessors[c]) {
+            if (unsolved_successors[p].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                pool.submit([&solve, p]() { solve(p); });
+            }
+        }
+    };
+
+    // Collect the sinks first, once tasks run they may bring other counters to zero and submit those themselves
+    std::vector<unsigned int> sinks{};
+    for (unsigned int c = 0; c < components.size(); ++c) {
+        if (unsolved_successors[c] == 0) sinks.push_back(c);
+    }
+    for (const auto c: sinks) pool.submit([&solve, c]() { solve(c); });
+    pool.wait();
+
+    iterations = max_passes;
+    return vec;
+}
+
+auto LiveVariableAnalysis::compute_wto(unsigned int& iterations) const -> LiveVariablesVec {
+    LiveVariablesVec vec(n_ * 2);
+
+    // LV is a backward analysis, information flows from the final program points against the control flow
+    const auto order = dfa_utils::weak_topological_order(pps_, dfa_utils::reverse_flow(cf_), final_pps_);
+    iterations = stabilize(order, vec);
+
+    return vec;
+}
+
+unsigned int LiveVariableAnalysis::stabilize(const WTO& order, LiveVariablesVec& vec) const {
+    unsigned int max_iterations = 1;
+
+    for (const auto& element: order) {
+        const std::size_t i = element.pp_ - 1;
+
+        if (!element.is_component_) {
+            update_pp(i, vec);
+            continue;
+        }
+
+        // Every cycle of the component passes its head, once the head is stable the component is
+        unsigned int iterations = 1;
+        update_pp(i, vec);
+        max_iterations = std::max(max_iterations, stabilize(element.component_, vec));
+        while (update_pp(i, vec)) {
+            max_iterations = std::max(max_iterations, stabilize(element.component_, vec));
+            ++iterations;
+        }
+
+        max_iterations = std::max(max_iterations, iterations);
+    }
+
+    return max_iterations;
+}
+
+namespace {
+    /*
+     * The transfer function of a statement from its exit to its entry, f(L) = gen ∪ (L \ kill).
+     *  x := a          gen = FV(a)                 kill = { x }
+     *  S1; S2          gen = gen1 ∪ (gen2 \ kill1) kill = kill1 ∪ kill2
+     *  if b S1 S2      gen = FV(b) ∪ gen1 ∪ gen2    kill = kill1 ∩ kill2
+     *  while b S       gen = FV(b) ∪ gen           kill = ∅ (least solution of X = FV(b) ∪ L ∪ f(X))
+     */
+    struct Summary {
+        LiveVariables gen_;
+        LiveVariables kill_;
+
+        [[nodiscard]] LiveVariables apply(const LiveVariables& out) const {
+            auto in = var_ptr_set_difference(out, kill_);
+            in.insert(gen_.begin(), gen_.end());
+            return in;
+        }
+    };
+
+    class StructuralSolver {
+    public:
+        explicit StructuralSolver(LiveVariablesVec& vec): vec_{vec} {}
+
+        /*
+         * Takes the summaries of ifs and whiles from the cache, their variables are resolved by name in vars.
+         */
+        StructuralSolver(LiveVariablesVec& vec, SummaryCache::Summaries cached, const FreeVariables& vars):
+            vec_{vec}, cached_{std::move(cached)}
+        {
+            for (const auto* var: vars) vars_.emplace(var->name_, var);
+        }
+
+        const Summary& summarize(const Stmt* stmt) {
+            if (const auto it = cached_.find(stmt); it != cached_.end()) {
+                Summary summary{};
+                for (const auto& name: it->second->gen_) summary.gen_.insert(vars_.at(name));
+                for (const auto& name: it->second->kill_) summary.kill_.insert(vars_.at(name));
+                return summaries_.insert_or_assign(stmt, std::move(summary)).first->second;
+            }
+
+            auto visitor = overload {
+                [](const Skip& s) -> Summary {
+                    return {};
+                },
+                [](const Assign& a) -> Summary {
+                    return { dfa_utils::free_variables_aexp(a.aexp_.get()), { a.var_.get() } };
+                },
+                [this](const If& i) -> Summary {
+                    const auto& then_summary = summarize(i.then_.get());
+                    const auto& else_summary = summarize(i.else_.get());
+
+                    auto gen = dfa_utils::free_variables_bexp(i.cond_->bexp_.get());
+                    gen.insert(then_summary.gen_.begin(), then_summary.gen_.end());
+                    gen.insert(else_summary.gen_.begin(), else_summary.gen_.end());
+                    return { std::move(gen), var_ptr_set_intersection(then_summary.kill_, else_summary.kill_) };
+                },
+                [this](const While& w) -> Summary {
+                    const auto& body_summary = summarize(w.body_.get());
+
+                    auto gen = dfa_utils::free_variables_bexp(w.cond_->bexp_.get());
+                    gen.insert(body_summary.gen_.begin(), body_summary.gen_.end());
+                    return { std::move(gen), {} };
+                },
+                [this](const SeqComp& sc) -> Summary {
+                    const auto& fst_summary = summarize(sc.fst_.get());
+                    const auto& snd_summary = summarize(sc.snd_.get());
+
+                    auto gen = var_ptr_set_difference(snd_summary.gen_, fst_summary.kill_);
+                    gen.insert(fst_summary.gen_.begin(), fst_summary.gen_.end());
+                    auto kill = fst_summary.kill_;
+                    kill.insert(snd_summary.kill_.begin(), snd_summary.kill_.end());
+                    return { std::move(gen), std::move(kill) };
                 }
+            };
+
+            auto summary = std::visit(visitor, *stmt);
+            return summaries_.insert_or_assign(stmt, std::move(summary)).first->second;
+        }
+
+        /*
+         * Sets entry and exit of every program point in stmt, given the live variables at the exit of stmt.
+         * Returns the live variables at the entry of stmt.
+         */
+        LiveVariables push_down(const Stmt* stmt, const LiveVariables& out) {
+            auto visitor = overload {
+                [this, &out](const Skip& s) {
+                    return set(s.pp_, out, out);
+                },
+                [this, &out, stmt](const Assign& a) {
+                    return set(a.pp_, summary(stmt).apply(out), out);
+                },
+                [this, &out](const If& i) {
+                    auto cond_out = push_down(i.then_.get(), out);
+                    cond_out.merge(push_down(i.else_.get(), out));
+
+                    auto cond_in = dfa_utils::free_variables_bexp(i.cond_->bexp_.get());
+                    cond_in.insert(cond_out.begin(), cond_out.end());
+                    return set(i.cond_->pp_, std::move(cond_in), std::move(cond_out));
+                },
+                [this, &out, stmt](const While& w) {
+                    // The entry of the condition is the closed form FV(b) ∪ gen(body) ∪ L, it is also the exit of the body
+                    auto cond_in = summary(stmt).gen_;
+                    cond_in.insert(out.begin(), out.end());
+
+                    auto cond_out = push_down(w.body_.get(), cond_in);
+                    cond_out.insert(out.begin(), out.end());
+                    return set(w.cond_->pp_, std::move(cond_in), std::move(cond_out));
+                },
+                [this, &out](const SeqComp& sc) {
+                    return push_down(sc.fst_.get(), push_down(sc.snd_.get(), out));
+                }
+            };
+
+            return std::visit(visitor, *stmt);
+        }
+
+    private:
+        LiveVariablesVec& vec_;
+        std::unordered_map<const Stmt*, Summary> summaries_;
+        SummaryCache::Summaries cached_;
+        std::unordered_map<std::string, const Var*> vars_;
+
+        // Summaries that push_down needs but were not computed upfront are computed on first use
+        const Summary& summary(const Stmt* stmt) {
+            if (const auto it = summaries_.find(stmt); it != summaries_.end()) return it->second;
+            return summarize(stmt);
+        }
+
+        LiveVariables set(PP pp, LiveVariables in, LiveVariables out) {
+            vec_[2 * (pp - 1)] = in;
+            vec_[2 * (pp - 1) + 1] = std::move(out);
+            return in;
+        }
+    };
+}
+
+auto LiveVariableAnalysis::compute_structural(unsigned int& iterations) const -> LiveVariablesVec {
+    LiveVariablesVec vec(n_ * 2);
+
+    // Nothing is live after the program
+    StructuralSolver solver{vec};
+    solver.summarize(stmt_);
+    solver.push_down(stmt_, {});
+
+    iterations = 1;
+    return vec;
+}
+
+auto LiveVariableAnalysis::compute_structural(unsigned int& iterations, SummaryCache& cache) const -> LiveVariablesVec {
+    LiveVariablesVec vec(n_ * 2);
+
+    // No bottom-up pass, push_down only needs the summaries of assignments and whiles
+    StructuralSolver solver{vec, cache.summaries(stmt_), dfa_utils::free_variables_stmt(stmt_)};
+    solver.push_down(stmt_, {});
+
+    iterations = 1;
+    return vec;
+}
+
+auto LiveVariableAnalysis::compute_delta(unsigned int& iterations) const -> LiveVariablesVec {
+    LiveVariablesVec vec(n_ * 2);
+
+    // Visit program points in weak topological order of the reversed flow, so a program point collects the
+    // deltas of all of its successors before it is visited, instead of once per arriving delta
+    std::vector<unsigned int> rank(n_);
+    unsigned int next_rank = 0;
+    std::function<void(const WTO&)> flatten = [&](const WTO& order) {
+        for (const auto& element: order) {
+            rank[element.pp_ - 1] = next_rank++;
+            flatten(element.component_);
+        }
+    };
+    flatten(dfa_utils::weak_topological_order(pps_, dfa_utils::reverse_flow(cf_), final_pps_));
+
+    // Variables that reached the exit of a program point but were not processed yet
+    std::vector<LiveVariables> pending(n_);
+    std::vector<bool> queued(n_, false);
+    std::priority_queue<std::pair<unsigned int, unsigned int>, std::vector<std::pair<unsigned int, unsigned int>>,
+                        std::greater<>> worklist{};
+
+    const auto propagate = [&](unsigned int i, const LiveVariables& delta) {
+        for (const auto p: predecessors_[i]) {
+            pending[p].insert(delta.begin(), delta.end());
+            if (!queued[p]) {
+                queued[p] = true;
+                worklist.emplace(rank[p], p);
+            }
+        }
+    };
+
+    // Seed every entry with gen, the only facts not coming from a successor
+    for (unsigned int i = 0; i < n_; ++i) {
+        vec[2*i] = transfers_[i].gen_;
+        if (!vec[2*i].empty()) propagate(i, vec[2*i]);
+    }
+
+    unsigned int visits = 0;
+    while (!worklist.empty()) {
+        const unsigned int i = worklist.top().second;
+        worklist.pop();
+        queued[i] = false;
+        ++visits;
+
+        const LiveVariables delta = std::move(pending[i]);
+        pending[i] = {};
+
+        // Only lookups in the (possibly large) entry and exit sets, no full set operations
+        const auto& kill = transfers_[i].kill_;
+        LiveVariables entry_delta{};
+        for (const auto var: delta) {
+            if (!vec[2*i + 1].insert(var).second) continue;
+            if (!kill.contains(var) && vec[2*i].insert(var).second) entry_delta.insert(var);
+        }
+
+        if (!entry_delta.empty()) propagate(i, entry_delta);
+    }
+
+    iterations = visits;
+    return vec;
+}
+
+auto LiveVariableAnalysis::compute_basic_blocks(unsigned int& iterations) const -> LVBlockSolution {
+    auto blocks = dfa_utils::basic_blocks(pps_, cf_);
+    const std::size_t n_blocks = blocks.size();
+
+    std::vector<unsigned int> block_of(n_);
+    for (unsigned int b = 0; b < n_blocks; ++b) {
+        for (const auto pp: blocks[b]) block_of[pp - 1] = b;
+    }
+
+    // Compose the transfer functions backwards through the block, f_block = f_first ∘ ... ∘ f_last
+    std::vector<LiveVariables> gen(n_blocks), kill(n_blocks);
+    std::vector<std::vector<unsigned int>> successors(n_blocks);
+    for (unsigned int b = 0; b < n_blocks; ++b) {
+        for (auto it = blocks[b].rbegin(); it != blocks[b].rend(); ++it) {
+            const Transfer& transfer = transfers_[*it - 1];
+            for (const auto var: transfer.kill_) {
+                gen[b].erase(var);
+                kill[b].insert(var);
+            }
+            gen[b].insert(transfer.gen_.begin(), transfer.gen_.end());
+        }
+
+        // Successors of the last program point are first program points of their blocks
+        for (const auto j: successors_[blocks[b].back() - 1]) successors[b].push_back(block_of[j]);
+    }
+
+    // Later blocks first, most edges point forward and LV flows backwards
+    LiveVariablesVec vec(n_blocks * 2);
+    unsigned int passes = 0;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto b = n_blocks; b-- > 0;) {
+            LiveVariables exit{};
+            for (const auto s: successors[b]) exit.insert(vec[2*s].begin(), vec[2*s].end());
+
+            LiveVariables entry = var_ptr_set_difference(exit, kill[b]);
+            entry.insert(gen[b].begin(), gen[b].end());
+
+            changed |= entry.size() != vec[2*b].size() || !var_ptr_set_equality(entry, vec[2*b]);
+            vec[2*b] = std::move(entry);
+            vec[2*b + 1] = std::move(exit);
+        }
+        ++passes;
+    }
+
+    iterations = passes;
+    return { *this, std::move(blocks), std::move(vec) };
+}
+
+auto LiveVariableAnalysis::compute_hash_consed(unsigned int& iterations) const -> LVSharedSolution {
+    auto table = std::make_unique<LVSetTable>();
+
+    std::vector<LVSet> gen{}, kill{};
+    gen.reserve(n_);
+    kill.reserve(n_);
+    for (unsigned int i = 0; i < n_; ++i) {
+        gen.push_back(table->make(transfers_[i].gen_));
+        kill.push_back(table->make(transfers_[i].kill_));
+    }
+
+    // F_LV on handles: nothing is copied, repeated operations on the same sets are memo lookups
+    std::vector<LVSet> vec(n_ * 2), next(n_ * 2);
+    iterations = 1;
+    while (true) {
+        for (unsigned int i = 0; i < n_; ++i) {
+            next[2*i] = table->unite(gen[i], table->difference(vec[2*i + 1], kill[i]));
+
+            LVSet out{};
+            for (const auto j: successors_[i]) out = table->unite(out, vec[2*j]);
+            next[2*i + 1] = std::move(out);
+        }
+
+        if (next == vec) break;
+
+        std::swap(vec, next);
+        ++iterations;
+    }
+
+    return { std::move(table), std::move(vec) };
+}
+
+auto LiveVariableAnalysis::compute_indexed(unsigned int& iterations) const -> LiveVariablesVec {
+    const VarIndex index{dfa_utils::free_variables_stmt(stmt_)};
+
+    const auto to_vec = [&index](const auto& sets) {
+        LiveVariablesVec vec{};
+        vec.reserve(sets.size());
+        for (const auto& set: sets) vec.push_back(index.to_set(set));
+        return vec;
+    };
+
+    // The words of small sets are stored inline, the transfers do not allocate
+    if (index.size() <= FixedVarSet<1>::max_vars) return to_vec(solve_indexed<FixedVarSet<1>>(index, iterations));
+    if (index.size() <= FixedVarSet<2>::max_vars) return to_vec(solve_indexed<FixedVarSet<2>>(index, iterations));
+    if (index.size() <= FixedVarSet<4>::max_vars) return to_vec(solve_indexed<FixedVarSet<4>>(index, iterations));
+    if (index.size() <= dense_var_limit) return to_vec(solve_indexed<DenseVarSet>(index, iterations));
+    return to_vec(solve_indexed<SparseVarSet>(index, iterations));
+}
+
+template<typename Set>
+auto LiveVariableAnalysis::solve_indexed(const VarIndex& index, unsigned int& iterations) const -> std::vector<Set> {
+    std::vector<Set> gen{}, kill{};
+    gen.reserve(n_);
+    kill.reserve(n_);
+    for (unsigned int i = 0; i < n_; ++i) {
+        gen.push_back(index.make<Set>(transfers_[i].gen_));
+        kill.push_back(index.make<Set>(transfers_[i].kill_));
+    }
+
+    // F_LV in place on the sets of next, which keep their storage from one iteration to the next
+    std::vector<Set> vec(n_ * 2, Set{index.size()}), next{vec};
+    iterations = 1;
+    while (true) {
+        for (unsigned int i = 0; i < n_; ++i) {
+            auto& entry = next[2*i];
+            entry = vec[2*i + 1];
+            entry.subtract(kill[i]);
+            entry.unite(gen[i]);
+
+            auto& exit = next[2*i + 1];
+            if (successors_[i].empty()) {
+                exit.clear();
+                continue;
             }
-            vec[2*i + 1] = union_entries_succ;
+            exit = vec[2*successors_[i][0]];
+            for (std::size_t k = 1; k < successors_[i].size(); ++k) exit.unite(vec[2*successors_[i][k]]);
         }
+
+        if (next == vec) break;
+
+        std::swap(vec, next);
+        ++iterations;
     }
 
     return vec;
 }
 
+template auto LiveVariableAnalysis::solve_indexed<FixedVarSet<1>>(const VarIndex&, unsigned int&) const -> std::vector<FixedVarSet<1>>;
+template auto LiveVariableAnalysis::solve_indexed<FixedVarSet<2>>(const VarIndex&, unsigned int&) const -> std::vector<FixedVarSet<2>>;
+template auto LiveVariableAnalysis::solve_indexed<FixedVarSet<4>>(const VarIndex&, unsigned int&) const -> std::vector<FixedVarSet<4>>;
+template auto LiveVariableAnalysis::solve_indexed<DenseVarSet>(const VarIndex&, unsigned int&) const -> std::vector<DenseVarSet>;
+template auto LiveVariableAnalysis::solve_indexed<SparseVarSet>(const VarIndex&, unsigned int&) const -> std::vector<SparseVarSet>;
+
+unsigned int LiveVariableAnalysis::replace_block(const Stmt* program, PP pp, const Stmt* replacement, LiveVariablesVec& vec) {
+    if (pp < 1 || pp > n_) throw std::runtime_error("Invalid mapping index!");
+    if (!dfa_utils::well_formed(replacement)) throw std::runtime_error("Replacement is not well-formed!");
+
+    auto info = dfa_utils::program_info(replacement);
+    const unsigned int n = n_ + info.pps_.size() - 1;
+    if (!info.pps_.contains(pp)) throw std::runtime_error("Replacement has to keep the program point!");
+    for (const auto q: info.pps_) {
+        if (q != pp && (q <= n_ || q > n)) throw std::runtime_error("Replacement has to number new program points from n + 1!");
+    }
+    if (final_pps_.contains(pp)) {
+        for (const auto& [from, to]: info.cf_) {
+            if (info.final_pps_.contains(from)) throw std::runtime_error("Program does not have isolated exits!");
+        }
+    }
+
+    const PP init = dfa_utils::initial_pp(replacement);
+    const LiveVariables old_entry = std::move(vec[2 * (pp - 1)]);
+    const auto preds = std::exchange(predecessors_[pp - 1], {});
+    const auto succs = std::exchange(successors_[pp - 1], {});
+
+    n_ = n;
+    pps_.insert(info.pps_.begin(), info.pps_.end());
+    blocks_.resize(n_);
+    transfers_.resize(n_);
+    successors_.resize(n_);
+    predecessors_.resize(n_);
+    vec.resize(n_ * 2);
+    for (const auto block: dfa_utils::blocks(replacement)) set_block(block->pp_ - 1, block);
+
+    // Flow inside the replacement, then reconnect the edges of pp to its initial and final program points
+    for (const auto& [from, to]: info.cf_) {
+        cf_.emplace(from, to);
+        successors_[from - 1].push_back(to - 1);
+        predecessors_[to - 1].push_back(from - 1);
+    }
+    for (const auto p: preds) {
+        cf_.erase({ p + 1, pp });
+        cf_.emplace(p + 1, init);
+        std::replace(successors_[p].begin(), successors_[p].end(), pp - 1, init - 1);
+        predecessors_[init - 1].push_back(p);
+    }
+    for (const auto s: succs) {
+        cf_.erase({ pp, s + 1 });
+        std::erase(predecessors_[s], pp - 1);
+        for (const auto f: info.final_pps_) {
+            cf_.emplace(f, s + 1);
+            successors_[f - 1].push_back(s);
+            predecessors_[s].push_back(f - 1);
+        }
+    }
+    if (final_pps_.erase(pp)) final_pps_.insert(info.final_pps_.begin(), info.final_pps_.end());
+    stmt_ = program;
+
+    return repair(vec, { info.pps_.begin(), info.pps_.end() }, init, old_entry);
+}
+
+unsigned int LiveVariableAnalysis::replace_condition(PP pp, const Cond* cond, LiveVariablesVec& vec) {
+    if (pp < 1 || pp > n_) throw std::runtime_error("Invalid mapping index!");
+    if (cond->pp_ != pp) throw std::runtime_error("Replacement has to keep the program point!");
+
+    set_block(pp - 1, cond);
+    const LiveVariables old_entry = vec[2 * (pp - 1)];
+    return repair(vec, { pp }, pp, old_entry);
+}
+
+unsigned int LiveVariableAnalysis::repair(LiveVariablesVec& vec, const std::vector<PP>& region, PP init,
+                                          const LiveVariables& old_entry) const {
+    std::vector<bool> reseed(n_, false);
+    for (const auto q: region) {
+        vec[2 * (q - 1)].clear();
+        vec[2 * (q - 1) + 1].clear();
+        reseed[q - 1] = true;
+    }
+
+    // Over-delete, every variable is removed at most once per program point
+    std::vector<std::pair<unsigned int, LiveVariables>> deletions{};
+    for (const auto p: predecessors_[init - 1]) {
+        if (!reseed[p]) deletions.emplace_back(p, old_entry);
+    }
+    while (!deletions.empty()) {
+        auto [i, vars] = std::move(deletions.back());
+        deletions.pop_back();
+
+        const auto& [gen, kill] = transfers_[i];
+        LiveVariables lost{};
+        for (const auto var: vars) {
+            if (!vec[2*i + 1].erase(var)) continue;
+            reseed[i] = true;
+            if (!gen.contains(var) && !kill.contains(var) && vec[2*i].erase(var)) lost.insert(var);
+        }
+
+        if (lost.empty()) continue;
+        for (const auto p: predecessors_[i]) deletions.emplace_back(p, lost);
+    }
+
+    // Re-derive, later program points first
+    std::priority_queue<unsigned int> worklist{};
+    std::vector<bool> queued(n_, false);
+    for (unsigned int i = 0; i < n_; ++i) {
+        if (reseed[i]) {
+            worklist.push(i);
+            queued[i] = true;
+        }
+    }
+
+    unsigned int visits = 0;
+    while (!worklist.empty()) {
+        const unsigned int i = worklist.top();
+        worklist.pop();
+        queued[i] = false;
+        ++visits;
+
+        if (!update_pp(i, vec)) continue;
+        for (const auto p: predecessors_[i]) {
+            if (!queued[p]) {
+                worklist.push(p);
+                queued[p] = true;
+            }
+        }
+    }
+
+    return visits;
+}
+
+bool LiveVariableAnalysis::update_pp(std::size_t i, LiveVariablesVec& vec) const {
+    const Transfer& transfer = transfers_[i];
+
+    LiveVariables exit{};
+    for (const auto j: successors_[i]) {
+        exit.insert(vec[2*j].begin(), vec[2*j].end());
+    }
+
+    LiveVariables entry = var_ptr_set_difference(exit, transfer.kill_);
+    entry.insert(transfer.gen_.begin(), transfer.gen_.end());
+
+    const bool changed = entry.size() != vec[2*i].size() || !var_ptr_set_equality(entry, vec[2*i]);
+    vec[2*i] = std::move(entry);
+    vec[2*i + 1] = std::move(exit);
+
+    return changed;
+}
+
+unsigned int LiveVariableAnalysis::solve_component(const std::vector<PP>& component, LiveVariablesVec& vec) const {
+    // A single program point without a self loop depends only on solved components
+    if (component.size() == 1) {
+        const std::size_t i = component.front() - 1;
+        update_pp(i, vec);
+        if (std::find(successors_[i].begin(), successors_[i].end(), i) == successors_[i].end()) return 1;
+    }
+
+    // Components list later program points first, which suits a backward analysis
+    unsigned int passes = 0;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (const auto pp: component) changed |= update_pp(pp - 1, vec);
+        ++passes;
+    }
+
+    return passes;
+}
+
+std::vector<std::size_t> LiveVariableAnalysis::chunk_bounds(const LiveVariablesVec& vec, unsigned int n_threads) const {
+    // Smallest number of program points whose entry/exit pairs span whole cache lines,
+    // so neighbouring chunks do not write to the same line
+    constexpr std::size_t cache_line = 64;
+    constexpr std::size_t pair_size = 2 * sizeof(LiveVariables);
+    constexpr std::size_t line_pps = std::lcm(pair_size, cache_line) / pair_size;
+
+    // First program point whose entry starts a line, the allocator only guarantees alignof(LiveVariables)
+    const auto address = reinterpret_cast<std::uintptr_t>(vec.data());
+    std::size_t first = 0;
+    while (first < line_pps && (address + first * pair_size) % cache_line != 0) ++first;
+    if (first == line_pps) first = 0;
+
+    // A few chunks per thread to balance uneven program points
+    const std::size_t n = vec.size() / 2;
+    const std::size_t target = std::max<std::size_t>(n / (4 * std::max(n_threads, 1u)), 1);
+    const std::size_t chunk = (target + line_pps - 1) / line_pps * line_pps;
+
+    std::vector<std::size_t> bounds{0};
+    if (first > 0 && first < n) bounds.push_back(first);
+    while (bounds.back() < n) bounds.push_back(std::min(bounds.back() + chunk, n));
+    return bounds;
+}
+
 PP LiveVariableAnalysis::f(unsigned int i) const {
     unsigned int pp_idx = i + 1;
     for (const auto& e: pps_) { if (e == pp_idx) return e; }
@@ -67,6 +789,24 @@ PP LiveVariableAnalysis::f(unsigned int i) const {
     throw std::runtime_error("Invalid mapping index!");
 }
 
+bool LiveVariableAnalysis::fixpoint_reached_parallel(const LiveVariablesVec& vec1, const LiveVariablesVec& vec2,
+                                                     ThreadPool& pool) {
+    if (vec1.size() != vec2.size()) throw std::runtime_error("Vector changed size?!");
+
+    std::atomic<bool> changed{false};
+    const std::size_t grain = std::max<std::size_t>(vec1.size() / (4 * pool.size()), 1);
+
+    pool.parallel_for(vec1.size(), grain, [&](std::size_t begin, std::size_t end) {
+        for (auto i = begin; i < end && !changed.load(std::memory_order_relaxed); ++i) {
+            if (vec1[i].size() != vec2[i].size() || !var_ptr_set_equality(vec1[i], vec2[i])) {
+                changed.store(true, std::memory_order_relaxed);
+            }
+        }
+    });
+
+    return !changed;
+}
+
 bool LiveVariableAnalysis::fixpoint_reached(const LiveVariablesVec& vec1, const LiveVariablesVec& vec2) {
     if (vec1.size() != vec2.size()) throw std::runtime_error("Vector changed size?!");
 
@@ -85,35 +825,28 @@ bool LiveVariableAnalysis::fixpoint_reached(const LiveVariablesVec& vec1, const
 }
 
 auto LiveVariableAnalysis::gen_LV(const Block* block) const -> LiveVariables {
-    // Block is no std::variant, cant use std::visit here
-    if (auto a = dynamic_cast<const Assign*>(block)) {
-        return dfa_utils::free_variables_aexp(a->aexp_.get());
-
-    } else if (auto s = dynamic_cast<const Skip*>(block)) {
-        return {};
-
-    } else if (auto c = dynamic_cast<const Cond*>(block)) {
-        return dfa_utils::free_variables_bexp(c->bexp_.get());
-
-    } else {
-        throw std::runtime_error("Unknown Block!");
+    switch (block->kind_) {
+        case BlockKind::Assign:
+            return dfa_utils::free_variables_aexp(static_cast<const Assign*>(block)->aexp_.get());
+        case BlockKind::Skip:
+            return LiveVariables{analysis_memory::resource()};
+        case BlockKind::Cond:
+            return dfa_utils::free_variables_bexp(static_cast<const Cond*>(block)->bexp_.get());
     }
+
+    throw std::runtime_error("Unknown Block!");
 }
 
 auto LiveVariableAnalysis::kill_LV(const Block* block) const -> LiveVariables {
-    // Block is no std::variant, cant use std::visit here
-    if (auto a = dynamic_cast<const Assign*>(block)) {
-        return { a->var_.get() };
-
-    } else if (auto s = dynamic_cast<const Skip*>(block)) {
-        return {};
-
-    } else if (auto c = dynamic_cast<const Cond*>(block)) {
-        return {};
-
-    } else {
-        throw std::runtime_error("Unknown Block!");
+    switch (block->kind_) {
+        case BlockKind::Assign:
+            return LiveVariables{{ static_cast<const Assign*>(block)->var_.get() }, analysis_memory::resource()};
+        case BlockKind::Skip:
+        case BlockKind::Cond:
+            return LiveVariables{analysis_memory::resource()};
     }
+
+    throw std::runtime_error("Unknown Block!");
 }
 
 /*void LiveVariableAnalysis::check_and_enforce_analysis_constraints(const std::unique_ptr<Stmt>& stmt)
@@ -133,24 +866,179 @@ auto LiveVariableAnalysis::kill_LV(const Block* block) const -> LiveVariables {
 }*/
 
 void LiveVariableAnalysis::init(const Stmt* stmt) {
-    pps_ = dfa_utils::program_points(stmt);
+    auto info = dfa_utils::program_info(stmt);
+    pps_ = std::move(info.pps_);
     n_ = pps_.size();
-    cf_ = dfa_utils::control_flow(stmt);
-    final_pps_ = dfa_utils::final_pps(stmt);
+    cf_ = std::move(info.cf_);
+    final_pps_ = std::move(info.final_pps_);
+
+    init_tables(stmt);
+}
+
+void LiveVariableAnalysis::init_tables(const Stmt* stmt) {
+    // Program points are 1, ..., n (see f), point i + 1 is stored at index i
+    if (!pps_.empty() && (*pps_.begin() != 1 || *pps_.rbegin() != n_)) throw std::runtime_error("Invalid mapping index!");
+
+    // Blocks come sorted by program point, the sets are moved into the table and stay in the arena
+    blocks_.assign(n_, nullptr);
+    transfers_.clear();
+    transfers_.reserve(n_);
+    for (const auto block: dfa_utils::blocks(stmt)) {
+        blocks_[block->pp_ - 1] = block;
+        transfers_.push_back({ gen_LV(block), kill_LV(block) });
+    }
+    if (transfers_.size() != n_) throw std::runtime_error("Invalid mapping index!");
+
+    // Final program points have no successors, their exit stays empty
+    successors_.assign(n_, {});
+    predecessors_.assign(n_, {});
+    for (const auto& [from, to]: cf_) {
+        if (final_pps_.contains(from)) continue;
+        successors_[from - 1].push_back(to - 1);
+        predecessors_[to - 1].push_back(from - 1);
+    }
 }
 
-void LiveVariableAnalysis::print_result(const LiveVariablesVec& res) {
-    std::cout << "Result of LV-analysis:\n";
+void LiveVariableAnalysis::set_block(unsigned int i, const Block* block) {
+    blocks_[i] = block;
+    transfers_[i] = { gen_LV(block), kill_LV(block) };
+}
+
+void LiveVariableAnalysis::print_result(const LiveVariablesVec& res, std::ostream& os) {
+    os << "Result of LV-analysis:\n";
     for(auto i = 0; i < res.size(); ++i) {
-        std::cout << "\tvec[" << i << "]: ";
-        if (res[i].empty()) std::cout << "{ }";
+        os << "\tvec[" << i << "]: ";
+        if (res[i].empty()) os << "{ }";
         else {
-            std::cout << "{  ";
+            os << "{  ";
             for(const auto &se: res[i]) {
-                std::cout << se->name_ << "  ";
+                os << se->name_ << "  ";
             }
-            std::cout << "}";
+            os << "}";
         }
-        std::cout << "\n";
+        os << "\n";
     }
-}
\ No newline at end of file
+}
+
+LVBlockSolution::LVBlockSolution(const LiveVariableAnalysis& lv, std::vector<std::vector<PP>> blocks, LiveVariablesVec vec):
+    lv_{&lv}, blocks_{std::move(blocks)}, block_of_(lv.n_), offset_of_(lv.n_), vec_{std::move(vec)},
+    cached_block_{std::numeric_limits<unsigned int>::max()}
+{
+    for (unsigned int b = 0; b < blocks_.size(); ++b) {
+        for (unsigned int k = 0; k < blocks_[b].size(); ++k) {
+            block_of_[blocks_[b][k] - 1] = b;
+            offset_of_[blocks_[b][k] - 1] = k;
+        }
+    }
+}
+
+auto LVBlockSolution::entry(PP pp) const -> LiveVariables {
+    if (pp < 1 || pp > block_of_.size()) throw std::runtime_error("Invalid mapping index!");
+
+    // The entry of a block is its first program point's
+    const unsigned int b = block_of_[pp - 1], k = offset_of_[pp - 1];
+    return k == 0 ? vec_[2*b] : reconstruct(b)[2*k];
+}
+
+auto LVBlockSolution::exit(PP pp) const -> LiveVariables {
+    if (pp < 1 || pp > block_of_.size()) throw std::runtime_error("Invalid mapping index!");
+
+    const unsigned int b = block_of_[pp - 1], k = offset_of_[pp - 1];
+    return k + 1 == blocks_[b].size() ? vec_[2*b + 1] : reconstruct(b)[2*k + 1];
+}
+
+auto LVBlockSolution::materialize() const -> LiveVariablesVec {
+    LiveVariablesVec res(block_of_.size() * 2);
+
+    LiveVariablesVec sets{};
+    for (unsigned int b = 0; b < blocks_.size(); ++b) {
+        expand(b, sets);
+        for (unsigned int k = 0; k < blocks_[b].size(); ++k) {
+            res[2 * (blocks_[b][k] - 1)] = std::move(sets[2*k]);
+            res[2 * (blocks_[b][k] - 1) + 1] = std::move(sets[2*k + 1]);
+        }
+    }
+
+    return res;
+}
+
+const LiveVariablesVec& LVBlockSolution::reconstruct(unsigned int block) const {
+    if (block != cached_block_) {
+        expand(block, cache_);
+        cached_block_ = block;
+    }
+
+    return cache_;
+}
+
+void LVBlockSolution::expand(unsigned int block, LiveVariablesVec& sets) const {
+    // Inside a block the exit of a program point is the entry of the next one
+    const auto& pps = blocks_[block];
+    sets.assign(pps.size() * 2, {});
+    LiveVariables out = vec_[2*block + 1];
+    for (auto k = pps.size(); k-- > 0;) {
+        const auto& transfer = lv_->transfers_[pps[k] - 1];
+
+        LiveVariables in = var_ptr_set_difference(out, transfer.kill_);
+        in.insert(transfer.gen_.begin(), transfer.gen_.end());
+        sets[2*k + 1] = std::move(out);
+        out = in;
+        sets[2*k] = std::move(in);
+    }
+}
+
+LVSharedSolution::LVSharedSolution(std::unique_ptr<LVSetTable> table, std::vector<LVSet> vec):
+    table_{std::move(table)}, vec_{std::move(vec)}
+{
+    // Only the solution is needed from now on, intermediate sets go away with the memo
+    table_->clear_memo();
+}
+
+auto LVSharedSolution::entry(PP pp) const -> LiveVariables {
+    if (pp < 1 || pp > vec_.size() / 2) throw std::runtime_error("Invalid mapping index!");
+    return vec_[2 * (pp - 1)].to_set();
+}
+
+auto LVSharedSolution::exit(PP pp) const -> LiveVariables {
+    if (pp < 1 || pp > vec_.size() / 2) throw std::runtime_error("Invalid mapping index!");
+    return vec_[2 * (pp - 1) + 1].to_set();
+}
+
+auto LVSharedSolution::materialize() const -> LiveVariablesVec {
+    LiveVariablesVec vec{};
+    vec.reserve(vec_.size());
+    for (const auto& set: vec_) vec.push_back(set.to_set());
+    return vec;
+}
+
+LVSolver parse_lv_solver(const std::string& name) {
+    if (name == "round-robin") return LVSolver::RoundRobin;
+    if (name == "parallel-round-robin") return LVSolver::ParallelRoundRobin;
+    if (name == "scc") return LVSolver::SCC;
+    if (name == "parallel-scc") return LVSolver::ParallelSCC;
+    if (name == "wto") return LVSolver::WTO;
+    if (name == "structural") return LVSolver::Structural;
+    if (name == "delta") return LVSolver::Delta;
+    if (name == "basic-blocks") return LVSolver::BasicBlocks;
+    if (name == "hash-consed") return LVSolver::HashConsed;
+    if (name == "indexed") return LVSolver::Indexed;
+
+    throw std::invalid_argument("Unknown solver " + name + "!");
+}
+
+std::string lv_solver_name(LVSolver solver) {
+    switch (solver) {
+        case LVSolver::RoundRobin: return "round-robin";
+        case LVSolver::ParallelRoundRobin: return "parallel-round-robin";
+        case LVSolver::SCC: return "scc";
+        case LVSolver::ParallelSCC: return "parallel-scc";
+        case LVSolver::WTO: return "wto";
+        case LVSolver::Structural: return "structural";
+        case LVSolver::Delta: return "delta";
+        case LVSolver::BasicBlocks: return "basic-blocks";
+        case LVSolver::HashConsed: return "hash-consed";
+        case LVSolver::Indexed: return "indexed";
+    }
+
+    throw std::runtime_error("Unknown solver!");
+}
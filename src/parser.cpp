@@ -32,12 +32,34 @@ std::unique_ptr<Stmt> Parser::parse() {
     return parse_statement();
 }
 
+std::unique_ptr<Stmt> Parser::parse(StmtSpans& spans) {
+    spans_ = &spans;
+    auto stmt = parse();
+    spans_ = nullptr;
+
+    return stmt;
+}
+
+void Parser::record_span(const std::unique_ptr<Stmt>& stmt, unsigned int begin) {
+    if (spans_) spans_->insert_or_assign(stmt.get(), std::make_pair(begin, position_));
+}
+
+std::unique_ptr<Cond> Parser::parse_single_condition() {
+    if (position_ >= tokens_.size()) {
+        throw SyntaxError("Cannot parse empty condition!");
+    }
+
+    current_token_ = tokens_[position_];
+    return parse_condition();
+}
+
 unsigned int Parser::parse_program_point() {
     const auto number_lexeme = match(TokenKind::Number).second;
     return std::stoul(number_lexeme);
 }
 
 std::unique_ptr<Stmt> Parser::parse_statement() {
+    const unsigned int begin = position_;
     std::unique_ptr<Stmt> left_statement = nullptr;
 
     const auto& kind = current_token_.first;
@@ -52,18 +74,21 @@ std::unique_ptr<Stmt> Parser::parse_statement() {
     } else {
         throw SyntaxError("Expected skip, assignment, if, or while.");
     }
+    record_span(left_statement, begin);
 
     // Sequential composition
     if (kind == TokenKind::Semicolon) {
         match(TokenKind::Semicolon);
         auto right_statement = parse_statement();
 
-        return std::make_unique<Stmt>(
+        auto seq = std::make_unique<Stmt>(
             SeqComp{
                 std::move(left_statement),
                 std::move(right_statement)
             }
         );
+        record_span(seq, begin);
+        return seq;
     }
         
     return left_statement;
@@ -300,13 +325,13 @@ std::unique_ptr<BExp> Parser::parse_boolean_operation() {
     );
 }
 
-bool Parser::is_next_binary_op_opr() noexcept {
+bool Parser::is_next_binary_op_opr() {
     const unsigned int idx = get_idx_of_next_op();
     const auto& kindAtIdx = tokens_[idx].first;
     return kindAtIdx == TokenKind::RelationalOperand;
 }
 
-unsigned int Parser::get_idx_of_next_op() noexcept {
+unsigned int Parser::get_idx_of_next_op() {
     // Stack-based search of index of the next operator.
     //      Note that first open paren already matched.
     //
@@ -319,10 +344,18 @@ unsigned int Parser::get_idx_of_next_op() noexcept {
     unsigned int idx = position_;
 
     while (true) {
+        // Malformed input, the expression ends without an operator
+        if (idx >= tokens_.size()) {
+            throw SyntaxError("Expected boolean or relational operator!");
+        }
+
         if (tokens_[idx].first == TokenKind::OpenParen) {
             stack.emplace_back(idx);
         }
         else if (tokens_[idx].first == TokenKind::CloseParen) {
+            if (stack.empty()) {
+                throw SyntaxError("Expected boolean or relational operator!");
+            }
             stack.pop_back();
         }
 
@@ -0,0 +1,352 @@
+#include "partial_evaluator.hpp"
+
+#include <limits>
+#include <sstream>
+
+#include "ast_printer.hpp"
+
+
+PartialEvaluator::PartialEvaluator(State known, unsigned int unroll_budget):
+    initial_env_{known.begin(), known.end()}, unroll_budget_{unroll_budget} {}
+
+std::unique_ptr<Stmt> PartialEvaluator::specialize(const Stmt* stmt) {
+    if (!stmt) throw std::invalid_argument("Given Stmt is empty!");
+
+    env_ = initial_env_;
+
+    Residual out{};
+    specialize_stmt(stmt, out);
+
+    // Write back everything still known, the final state has to match the original program
+    std::vector<std::string> known_vars{};
+    for (const auto& [var, value]: env_) known_vars.push_back(var);
+    for (const auto& var: known_vars) materialize(var, out);
+
+    // Dropped skips may have been what gave the program isolated exits, a final loop condition has a successor
+    if (!out.empty() && ends_in_loop(out.back().get())) out.push_back(std::make_unique<Stmt>(Skip{0}));
+
+    auto residual = make_seq(std::move(out));
+    PP next = 1;
+    renumber(residual.get(), next);
+
+    return residual;
+}
+
+std::string PartialEvaluator::specialize_to_wlang(const Stmt* stmt) {
+    const auto residual = specialize(stmt);
+
+    std::ostringstream out{};
+    ASTSourcePrinter printer{out};
+    printer.print(*residual);
+    out << "\n";
+
+    return out.str();
+}
+
+void PartialEvaluator::specialize_stmt(const Stmt* stmt, Residual& out) {
+    auto visitor = overload {
+        [](const Skip& s) {},
+        [this, &out](const Assign& a) {
+            auto value = specialize_aexp(a.aexp_.get());
+            const auto& var = a.var_->name_;
+
+            if (value.known_) {
+                env_[var] = *value.known_;
+                return;
+            }
+
+            env_.erase(var);
+            out.push_back(std::make_unique<Stmt>(
+                Assign{0, std::make_unique<Var>(Var{var}), std::move(value.residual_)}
+            ));
+        },
+        [this, &out](const If& i) {
+            specialize_if(i, out);
+        },
+        [this, &out](const While& w) {
+            specialize_while(w, out);
+        },
+        [this, &out](const SeqComp& sc) {
+            specialize_stmt(sc.fst_.get(), out);
+            specialize_stmt(sc.snd_.get(), out);
+        }
+    };
+
+    std::visit(visitor, *stmt);
+}
+
+void PartialEvaluator::specialize_if(const If& i, Residual& out) {
+    auto cond = specialize_bexp(i.cond_->bexp_.get());
+
+    if (cond.known_) {
+        specialize_stmt(*cond.known_ ? i.then_.get() : i.else_.get(), out);
+        return;
+    }
+
+    const Env before = env_;
+
+    Residual then_out{};
+    specialize_stmt(i.then_.get(), then_out);
+    Env then_env = std::move(env_);
+
+    env_ = before;
+    Residual else_out{};
+    specialize_stmt(i.else_.get(), else_out);
+    Env else_env = std::move(env_);
+
+    // A variable stays known after the If only if both branches agree on its value
+    Env merged{};
+    for (const auto& [var, value]: then_env) {
+        auto it = else_env.find(var);
+        if (it != else_env.end() && it->second == value) merged.emplace(var, value);
+    }
+
+    // Otherwise the branches that know it write it back
+    for (auto [branch_env, branch_out]: { std::pair{&then_env, &then_out}, std::pair{&else_env, &else_out} }) {
+        env_ = std::move(*branch_env);
+        for (const auto& [var, value]: Env{env_}) {
+            if (!merged.contains(var)) materialize(var, *branch_out);
+        }
+    }
+
+    env_ = std::move(merged);
+    out.push_back(std::make_unique<Stmt>(
+        If{
+            std::make_unique<Cond>(0, lift(std::move(cond))),
+            make_seq(std::move(then_out)),
+            make_seq(std::move(else_out))
+        }
+    ));
+}
+
+void PartialEvaluator::specialize_while(const While& w, Residual& out) {
+    // Unroll as long as the condition is decidable and the budget allows
+    for (unsigned int iteration = 0; ; ++iteration) {
+        const auto cond = specialize_bexp(w.cond_->bexp_.get());
+
+        if (cond.known_ && !*cond.known_) return;
+        if (!cond.known_ || iteration >= unroll_budget_) break;
+
+        specialize_stmt(w.body_.get(), out);
+    }
+
+    // Residual loop: variables assigned in the body are unknown at the loop head
+    const auto assigned = assigned_vars(w.body_.get());
+    for (const auto& var: assigned) {
+        if (env_.contains(var)) materialize(var, out);
+    }
+
+    auto cond = specialize_bexp(w.cond_->bexp_.get());
+    if (cond.known_ && !*cond.known_) return;
+
+    const Env loop_env = env_;
+
+    Residual body_out{};
+    specialize_stmt(w.body_.get(), body_out);
+    for (const auto& var: assigned) {
+        if (env_.contains(var)) materialize(var, body_out);
+    }
+
+    env_ = loop_env;
+    out.push_back(std::make_unique<Stmt>(
+        While{
+            std::make_unique<Cond>(0, lift(std::move(cond))),
+            make_seq(std::move(body_out))
+        }
+    ));
+}
+
+PartialEvaluator::PartialAExp PartialEvaluator::specialize_aexp(const AExp* aexp) const {
+    auto visitor = overload {
+        [this](const Var& var) -> PartialAExp {
+            auto it = env_.find(var.name_);
+            if (it != env_.end()) return {it->second, nullptr};
+            return {std::nullopt, std::make_unique<AExp>(Var{var.name_})};
+        },
+        [](const Num& num) -> PartialAExp {
+            return {num.val_, nullptr};
+        },
+        [this](const ArithmeticOp& opa) -> PartialAExp {
+            const auto op = interpreter::arithmetic_op_kind(opa.op_);
+            auto lhs = specialize_aexp(opa.lhs_.get());
+            auto rhs = specialize_aexp(opa.rhs_.get());
+
+            if (lhs.known_ && rhs.known_) {
+                return {interpreter::apply(op, *lhs.known_, *rhs.known_), nullptr};
+            }
+
+            // Algebraic identities, expressions have no side effects so dropping operands is safe
+            const auto is = [](const PartialAExp& e, Value v) { return e.known_ && *e.known_ == v; };
+            if (op == ArithmeticOpKind::Add && is(lhs, 0)) return rhs;
+            if ((op == ArithmeticOpKind::Add || op == ArithmeticOpKind::Sub) && is(rhs, 0)) return lhs;
+            if (op == ArithmeticOpKind::Mul && (is(lhs, 0) || is(rhs, 0))) return {0, nullptr};
+            if (op == ArithmeticOpKind::Mul && is(lhs, 1)) return rhs;
+            if (op == ArithmeticOpKind::Mul && is(rhs, 1)) return lhs;
+
+            return {std::nullopt, std::make_unique<AExp>(
+                ArithmeticOp{lift(std::move(lhs)), opa.op_, lift(std::move(rhs))}
+            )};
+        }
+    };
+
+    return std::visit(visitor, *aexp);
+}
+
+PartialEvaluator::PartialBExp PartialEvaluator::specialize_bexp(const BExp* bexp) const {
+    auto visitor = overload {
+        [](const True&) -> PartialBExp {
+            return {true, nullptr};
+        },
+        [](const False&) -> PartialBExp {
+            return {false, nullptr};
+        },
+        [this](const Not& n) -> PartialBExp {
+            auto b = specialize_bexp(n.b_.get());
+            if (b.known_) return {!*b.known_, nullptr};
+            return {std::nullopt, std::make_unique<BExp>(Not{std::move(b.residual_)})};
+        },
+        [this](const BooleanOp& opb) -> PartialBExp {
+            const bool is_and = interpreter::boolean_op_kind(opb.op_) == BooleanOpKind::And;
+            auto lhs = specialize_bexp(opb.lhs_.get());
+            auto rhs = specialize_bexp(opb.rhs_.get());
+
+            // false dominates and, true dominates or, the other constant is the neutral element
+            const bool dominant = !is_and;
+            if ((lhs.known_ && *lhs.known_ == dominant) || (rhs.known_ && *rhs.known_ == dominant)) {
+                return {dominant, nullptr};
+            }
+            if (lhs.known_) return rhs;
+            if (rhs.known_) return lhs;
+
+            return {std::nullopt, std::make_unique<BExp>(
+                BooleanOp{std::move(lhs.residual_), opb.op_, std::move(rhs.residual_)}
+            )};
+        },
+        [this](const RelationalOp& opr) -> PartialBExp {
+            const auto op = interpreter::relational_op_kind(opr.op_);
+            auto lhs = specialize_aexp(opr.lhs_.get());
+            auto rhs = specialize_aexp(opr.rhs_.get());
+
+            if (lhs.known_ && rhs.known_) {
+                return {interpreter::apply(op, *lhs.known_, *rhs.known_), nullptr};
+            }
+
+            return {std::nullopt, std::make_unique<BExp>(
+                RelationalOp{lift(std::move(lhs)), opr.op_, lift(std::move(rhs))}
+            )};
+        }
+    };
+
+    return std::visit(visitor, *bexp);
+}
+
+void PartialEvaluator::materialize(const std::string& var, Residual& out) {
+    auto it = env_.find(var);
+    if (it == env_.end()) return;
+
+    out.push_back(std::make_unique<Stmt>(
+        Assign{0, std::make_unique<Var>(Var{var}), make_constant(it->second)}
+    ));
+    env_.erase(it);
+}
+
+std::unique_ptr<AExp> PartialEvaluator::lift(PartialAExp exp) {
+    return exp.known_ ? make_constant(*exp.known_) : std::move(exp.residual_);
+}
+
+std::unique_ptr<BExp> PartialEvaluator::lift(PartialBExp exp) {
+    if (!exp.known_) return std::move(exp.residual_);
+    return *exp.known_ ? std::make_unique<BExp>(True{}) : std::make_unique<BExp>(False{});
+}
+
+std::unique_ptr<AExp> PartialEvaluator::make_constant(Value value) {
+    // Numerals are unsigned 32-bit, other values are built with wrapping arithmetic
+    constexpr auto max_num = static_cast<Value>(std::numeric_limits<unsigned int>::max());
+    const auto num = [](std::uint64_t n) { return std::make_unique<AExp>(Num{static_cast<unsigned int>(n)}); };
+    const auto op = [](std::unique_ptr<AExp> lhs, const char* o, std::unique_ptr<AExp> rhs) {
+        return std::make_unique<AExp>(ArithmeticOp{std::move(lhs), o, std::move(rhs)});
+    };
+
+    if (value >= 0 && value <= max_num) return num(value);
+    if (value < 0 && value >= -max_num) return op(num(0), "-", num(-value));
+
+    // ((hi * 65536) * 65536) + lo
+    const auto bits = static_cast<std::uint64_t>(value);
+    return op(op(op(num(bits >> 32), "*", num(65536)), "*", num(65536)), "+", num(bits & 0xFFFFFFFFu));
+}
+
+std::unique_ptr<Stmt> PartialEvaluator::make_seq(Residual stmts) {
+    if (stmts.empty()) return std::make_unique<Stmt>(Skip{0});
+
+    auto seq = std::move(stmts.back());
+    for (auto it = std::next(stmts.rbegin()); it != stmts.rend(); ++it) {
+        seq = std::make_unique<Stmt>(SeqComp{std::move(*it), std::move(seq)});
+    }
+
+    return seq;
+}
+
+std::set<std::string> PartialEvaluator::assigned_vars(const Stmt* stmt) {
+    std::set<std::string> vars{};
+
+    auto visitor = overload {
+        [](const Skip& s) {},
+        [&vars](const Assign& a) {
+            vars.insert(a.var_->name_);
+        },
+        [&vars](const If& i) {
+            vars.merge(assigned_vars(i.then_.get()));
+            vars.merge(assigned_vars(i.else_.get()));
+        },
+        [&vars](const While& w) {
+            vars.merge(assigned_vars(w.body_.get()));
+        },
+        [&vars](const SeqComp& sc) {
+            vars.merge(assigned_vars(sc.fst_.get()));
+            vars.merge(assigned_vars(sc.snd_.get()));
+        }
+    };
+
+    std::visit(visitor, *stmt);
+
+    return vars;
+}
+
+bool PartialEvaluator::ends_in_loop(const Stmt* stmt) {
+    auto visitor = overload {
+        [](const Skip& s) { return false; },
+        [](const Assign& a) { return false; },
+        [](const If& i) { return ends_in_loop(i.then_.get()) || ends_in_loop(i.else_.get()); },
+        [](const While& w) { return true; },
+        [](const SeqComp& sc) { return ends_in_loop(sc.snd_.get()); }
+    };
+
+    return std::visit(visitor, *stmt);
+}
+
+void PartialEvaluator::renumber(Stmt* stmt, PP& next) {
+    // Program points in program order: conditions before their branches
+    auto visitor = overload {
+        [&next](Skip& s) {
+            s.pp_ = next++;
+        },
+        [&next](Assign& a) {
+            a.pp_ = next++;
+        },
+        [&next](If& i) {
+            i.cond_->pp_ = next++;
+            renumber(i.then_.get(), next);
+            renumber(i.else_.get(), next);
+        },
+        [&next](While& w) {
+            w.cond_->pp_ = next++;
+            renumber(w.body_.get(), next);
+        },
+        [&next](SeqComp& sc) {
+            renumber(sc.fst_.get(), next);
+            renumber(sc.snd_.get(), next);
+        }
+    };
+
+    std::visit(visitor, *stmt);
+}
@@ -0,0 +1,340 @@
+#include "pipeline.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include "batch.hpp"
+#include "bounded_queue.hpp"
+#include "dfa_utils.hpp"
+#include "io.hpp"
+#include "lexer.hpp"
+#include "lv.hpp"
+#include "parser.hpp"
+
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // A program on its way through the pipeline, every stage consumes the output of the previous one
+    struct Job {
+        std::size_t index_;
+        BatchResult result_;
+        std::string text_;
+        std::vector<Token> tokens_;
+        std::unique_ptr<Stmt> stmt_;
+        ProgramInfo info_;
+        std::string serialized_;
+    };
+
+    using JobPtr = std::unique_ptr<Job>;
+
+    struct StageState {
+        std::atomic<unsigned int> active_{0};     // Workers still running
+        std::atomic<bool> done_{false};           // All workers finished, output queue is complete
+        std::atomic<std::size_t> items_{0};
+        std::atomic<std::uint64_t> busy_ns_{0};
+        std::atomic<std::size_t> pushes_{0};
+        std::atomic<std::size_t> occupancy_sum_{0};
+        std::atomic<std::size_t> occupancy_max_{0};
+        std::atomic<std::size_t> full_stalls_{0};
+    };
+
+    class Pipeline {
+    public:
+        Pipeline(const std::vector<std::filesystem::path>& paths, const pipeline::Config& config, std::ostream& os):
+            paths_{paths}, config_{config}, os_{os}
+        {
+            if (config.solver_ == LVSolver::ParallelRoundRobin || config.solver_ == LVSolver::ParallelSCC) {
+                throw std::invalid_argument("The pipeline runs programs in parallel, use a sequential solver!");
+            }
+
+            for (std::size_t s = 0; s + 1 < pipeline::n_stages; ++s) {
+                queues_[s] = std::make_unique<BoundedQueue<JobPtr>>(config.queue_capacity_);
+                window_ += queues_[s]->capacity() + std::max(config.workers_[s], 1u);
+            }
+            window_ += std::max(config.workers_[pipeline::n_stages - 1], 1u);
+        }
+
+        pipeline::Report run() {
+            const auto start = Clock::now();
+
+            std::vector<std::thread> threads{};
+            for (std::size_t s = 0; s < pipeline::n_stages; ++s) {
+                const unsigned int workers = std::max(config_.workers_[s], 1u);
+                stages_[s].active_ = workers;
+                for (unsigned int w = 0; w < workers; ++w) threads.emplace_back(&Pipeline::worker, this, s);
+            }
+            for (auto& thread: threads) thread.join();
+
+            batch::write_summary(paths_.size(), failed_, os_);
+
+            const std::chrono::duration<double, std::milli> wall = Clock::now() - start;
+            return report(wall.count());
+        }
+
+    private:
+        const std::vector<std::filesystem::path>& paths_;
+        const pipeline::Config& config_;
+        std::ostream& os_;
+
+        std::array<StageState, pipeline::n_stages> stages_{};
+        std::array<std::unique_ptr<BoundedQueue<JobPtr>>, pipeline::n_stages - 1> queues_{};
+        std::atomic<std::size_t> next_path_{0};
+
+        // Bumped after every push to / pop from a queue and when a stage is done, idle workers wait on them
+        std::array<std::atomic<std::uint32_t>, pipeline::n_stages - 1> pushed_{};
+        std::array<std::atomic<std::uint32_t>, pipeline::n_stages - 1> popped_{};
+
+        // Reorder buffer, results are written in input order
+        std::mutex output_mutex_;
+        std::map<std::size_t, std::string> finished_;
+        std::size_t next_output_{0};
+        std::size_t failed_{0};
+
+        // Programs read but not yet written, at most what the queues and workers hold. Without the bound one
+        // slow program would let the other LV workers fill the reorder buffer with any number of later results.
+        std::size_t window_{0};
+        std::atomic<std::size_t> written_{0};
+
+        void worker(std::size_t s) {
+            while (auto job = next_job(s)) {
+                const auto start = Clock::now();
+                process(s, *job);
+                stages_[s].busy_ns_ += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+                ++stages_[s].items_;
+
+                if (s + 1 < pipeline::n_stages) push(s, job);
+                else output(std::move(job));
+            }
+
+            if (--stages_[s].active_ == 0) {
+                stages_[s].done_.store(true);
+                if (s + 1 < pipeline::n_stages) {
+                    ++pushed_[s];
+                    pushed_[s].notify_all();
+                }
+            }
+        }
+
+        JobPtr next_job(std::size_t s) {
+            // The first stage is fed directly from the list of paths
+            if (s == 0) {
+                const std::size_t idx = next_path_++;
+                if (idx >= paths_.size()) return nullptr;
+
+                for (auto written = written_.load(); idx >= written + window_; written = written_.load()) {
+                    written_.wait(written);
+                }
+
+                auto job = std::make_unique<Job>();
+                job->index_ = idx;
+                job->result_ = BatchResult{paths_[idx], false, "", 0, ""};
+                return job;
+            }
+
+            auto& in = *queues_[s - 1];
+            while (true) {
+                const auto pushed = pushed_[s - 1].load();
+                if (auto job = in.try_pop()) return take(s - 1, std::move(*job));
+
+                // Everything the upstream stage pushed is visible once it is done, try one last time
+                if (stages_[s - 1].done_.load()) {
+                    if (auto job = in.try_pop()) return take(s - 1, std::move(*job));
+                    return nullptr;
+                }
+
+                pushed_[s - 1].wait(pushed);
+            }
+        }
+
+        // Wakes a producer waiting for room in the queue
+        JobPtr take(std::size_t q, JobPtr job) {
+            ++popped_[q];
+            popped_[q].notify_one();
+            return job;
+        }
+
+        void push(std::size_t s, JobPtr& job) {
+            auto& out = *queues_[s];
+            auto& stats = stages_[s];
+
+            if (!out.try_push(job)) {
+                ++stats.full_stalls_;
+                while (true) {
+                    const auto popped = popped_[s].load();
+                    if (out.try_push(job)) break;
+                    popped_[s].wait(popped);
+                }
+            }
+            ++pushed_[s];
+            pushed_[s].notify_one();
+
+            const std::size_t occupancy = out.size();
+            ++stats.pushes_;
+            stats.occupancy_sum_ += occupancy;
+            std::size_t max = stats.occupancy_max_.load(std::memory_order_relaxed);
+            while (occupancy > max && !stats.occupancy_max_.compare_exchange_weak(max, occupancy)) {}
+        }
+
+        void process(std::size_t s, Job& job) const {
+            auto& result = job.result_;
+
+            // A failed program is passed on untouched, it still has to be written
+            if (!result.error_.empty()) return;
+
+            try {
+                switch (static_cast<pipeline::Stage>(s)) {
+                    case pipeline::Stage::Read: {
+                        const WLangReader reader{result.path_};
+                        if (!reader.is_open()) throw std::runtime_error("Error while opening file!");
+                        job.text_ = reader.read_program();
+                        break;
+                    }
+                    case pipeline::Stage::Tokenize: {
+                        Lexer lexer{std::move(job.text_)};
+                        job.tokens_ = lexer.tokenize();
+                        break;
+                    }
+                    case pipeline::Stage::Parse: {
+                        Parser parser{std::move(job.tokens_)};
+                        job.stmt_ = parser.parse();
+                        break;
+                    }
+                    case pipeline::Stage::ProgramInfo: {
+                        LiveVariableAnalysis::check_constraints(job.stmt_.get());
+                        job.info_ = dfa_utils::program_info(job.stmt_.get());
+                        break;
+                    }
+                    case pipeline::Stage::LV: {
+                        const LiveVariableAnalysis lv{job.stmt_.get(), std::move(job.info_)};
+                        const auto lvs = lv.compute(config_.solver_, result.iterations_);
+
+                        std::ostringstream output{};
+                        LiveVariableAnalysis::print_result(lvs, output);
+                        result.output_ = output.str();
+                        result.ok_ = true;
+
+                        // The result only refers to the AST until it is printed
+                        job.stmt_.reset();
+                        break;
+                    }
+                    case pipeline::Stage::Serialize: {
+                        std::ostringstream serialized{};
+                        batch::write_result(result, serialized);
+                        job.serialized_ = serialized.str();
+                        break;
+                    }
+                }
+            } catch (const std::exception& e) {
+                result.ok_ = false;
+                result.error_ = e.what();
+                job.stmt_.reset();
+            }
+
+            // Failures skip the remaining stages, serialize them as soon as they happen
+            if (!result.error_.empty() && job.serialized_.empty()) {
+                std::ostringstream serialized{};
+                batch::write_result(result, serialized);
+                job.serialized_ = serialized.str();
+            }
+        }
+
+        void output(JobPtr job) {
+            std::lock_guard lock{output_mutex_};
+
+            if (!job->result_.ok_) ++failed_;
+            finished_.emplace(job->index_, std::move(job->serialized_));
+
+            const std::size_t written = next_output_;
+            for (auto it = finished_.begin(); it != finished_.end() && it->first == next_output_; it = finished_.erase(it)) {
+                os_ << it->second;
+                ++next_output_;
+            }
+
+            if (next_output_ != written) {
+                written_.store(next_output_);
+                written_.notify_all();
+            }
+        }
+
+        pipeline::Report report(double wall_ms) const {
+            pipeline::Report report{paths_.size(), failed_, wall_ms, {}};
+
+            for (std::size_t s = 0; s < pipeline::n_stages; ++s) {
+                const auto& stats = stages_[s];
+                const std::size_t pushes = stats.pushes_;
+
+                report.stages_.push_back({
+                    pipeline::stage_name(static_cast<pipeline::Stage>(s)),
+                    std::max(config_.workers_[s], 1u),
+                    stats.items_,
+                    static_cast<double>(stats.busy_ns_) / 1e6,
+                    s + 1 < pipeline::n_stages ? queues_[s]->capacity() : 0,
+                    pushes ? static_cast<double>(stats.occupancy_sum_) / static_cast<double>(pushes) : 0.0,
+                    stats.occupancy_max_,
+                    stats.full_stalls_
+                });
+            }
+
+            return report;
+        }
+    };
+}
+
+
+std::string pipeline::stage_name(Stage stage) {
+    switch (stage) {
+        case Stage::Read: return "read";
+        case Stage::Tokenize: return "tokenize";
+        case Stage::Parse: return "parse";
+        case Stage::ProgramInfo: return "program info";
+        case Stage::LV: return "lv";
+        case Stage::Serialize: return "serialize";
+    }
+
+    throw std::runtime_error("Unknown pipeline stage!");
+}
+
+pipeline::Report pipeline::run(const std::vector<std::filesystem::path>& paths, const Config& config, std::ostream& os) {
+    Pipeline p{paths, config, os};
+    return p.run();
+}
+
+void pipeline::print_report(const Report& report, std::ostream& os) {
+    os << "Pipeline analyzed " << report.analyzed_ << " programs (" << report.failed_ << " failed) in "
+       << std::fixed << std::setprecision(1) << report.wall_ms_ << " ms\n";
+    os << std::left << std::setw(14) << "stage" << std::right
+       << std::setw(8) << "workers" << std::setw(10) << "items" << std::setw(12) << "busy ms"
+       << std::setw(12) << "items/s" << std::setw(8) << "util"
+       << std::setw(10) << "queue" << std::setw(10) << "avg occ" << std::setw(9) << "max occ"
+       << std::setw(9) << "stalls" << "\n";
+
+    for (const auto& stage: report.stages_) {
+        // Throughput of one worker while busy, utilization relative to the wall time of all workers
+        const double items_per_s = stage.busy_ms_ > 0 ? stage.items_ * stage.workers_ * 1000.0 / stage.busy_ms_ : 0.0;
+        const double util = report.wall_ms_ > 0 ? stage.busy_ms_ / (report.wall_ms_ * stage.workers_) : 0.0;
+
+        os << std::left << std::setw(14) << stage.name_ << std::right
+           << std::setw(8) << stage.workers_ << std::setw(10) << stage.items_
+           << std::setw(12) << std::setprecision(2) << stage.busy_ms_
+           << std::setw(12) << std::setprecision(0) << items_per_s
+           << std::setw(7) << std::setprecision(0) << util * 100 << "%";
+
+        if (stage.queue_capacity_ == 0) os << std::setw(10) << "-" << std::setw(10) << "-" << std::setw(9) << "-" << std::setw(9) << "-";
+        else {
+            os << std::setw(10) << stage.queue_capacity_ << std::setw(10) << std::setprecision(2) << stage.avg_occupancy_
+               << std::setw(9) << stage.max_occupancy_ << std::setw(9) << stage.full_stalls_;
+        }
+        os << "\n";
+    }
+
+    os.unsetf(std::ios::floatfield);
+    os << std::setprecision(6);
+}
@@ -0,0 +1,282 @@
+#include "result_store.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <set>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "io.hpp"
+
+
+namespace {
+    constexpr std::string_view file_magic{"SDPALV\0", 7};
+    constexpr std::uint8_t version = 1;
+    constexpr std::size_t header_size = 16;
+
+    enum class RowTag: std::uint8_t { Bitset, Runs, Same };
+
+    void write_u32(std::string& out, std::size_t value) {
+        if (value > std::numeric_limits<std::uint32_t>::max()) throw std::runtime_error("LV result is too large to store!");
+
+        const auto v = static_cast<std::uint32_t>(value);
+        char bytes[sizeof(v)];
+        std::memcpy(bytes, &v, sizeof(v));
+        out.append(bytes, sizeof(v));
+    }
+
+    void write_varint(std::string& out, std::uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    /*
+     * The shorter of bitset and run-length encoding of the sorted variable indices.
+     */
+    std::string encode_row(const std::vector<unsigned int>& indices, unsigned int n_vars) {
+        std::string runs(1, static_cast<char>(RowTag::Runs));
+        std::string lengths{};
+        std::size_t n_runs = 0;
+        unsigned int next = 0;
+        for (std::size_t i = 0; i < indices.size();) {
+            std::size_t j = i + 1;
+            while (j < indices.size() && indices[j] == indices[j - 1] + 1) ++j;
+
+            write_varint(lengths, indices[i] - next);
+            write_varint(lengths, j - i);
+            n_runs += 2;
+            next = indices[j - 1] + 1;
+            i = j;
+        }
+        write_varint(runs, n_runs);
+        runs += lengths;
+
+        std::string bitset(1 + (n_vars + 7) / 8, '\0');
+        bitset[0] = static_cast<char>(RowTag::Bitset);
+        for (const auto index: indices) bitset[1 + index / 8] |= static_cast<char>(1 << (index % 8));
+
+        return runs.size() <= bitset.size() ? runs : bitset;
+    }
+
+    [[noreturn]] void malformed() {
+        throw std::runtime_error("Malformed LV result store!");
+    }
+}
+
+LVResultStore::LVResultStore(const std::filesystem::path& path):
+    source_{std::make_unique<ProgramSource>(path)}, data_{source_->text()}
+{
+    if (data_.size() < header_size || !data_.starts_with(file_magic)) throw std::runtime_error("Not an LV result store!");
+
+    const auto file_version = static_cast<std::uint8_t>(data_[file_magic.size()]);
+    if (file_version != version) {
+        throw std::runtime_error("Unsupported LV result store version " + std::to_string(file_version) + "!");
+    }
+
+    const auto n_vars = u32(8);
+    n_rows_ = u32(12);
+    if (n_rows_ % 2 != 0) malformed();
+
+    // Dictionary: offsets relative to the names, which follow the offset table
+    const std::size_t names = header_size + (static_cast<std::size_t>(n_vars) + 1) * 4;
+    if (names > data_.size()) malformed();
+
+    variables_.reserve(n_vars);
+    vars_.reserve(n_vars);
+    for (std::uint32_t i = 0; i < n_vars; ++i) {
+        const auto begin = u32(header_size + i * 4);
+        const auto end = u32(header_size + (i + 1) * 4);
+        if (begin > end || names + end > data_.size()) malformed();
+
+        variables_.push_back(data_.substr(names + begin, end - begin));
+        if (i > 0 && !(variables_[i - 1] < variables_[i])) malformed();
+        vars_.push_back(Var{std::string{variables_.back()}});
+    }
+
+    // Rows: the offset table is 4-byte aligned, offsets are relative to the first row
+    const std::size_t names_end = names + u32(header_size + n_vars * 4);
+    row_offsets_ = (names_end + 3) / 4 * 4;
+    rows_ = row_offsets_ + (static_cast<std::size_t>(n_rows_) + 1) * 4;
+    if (rows_ > data_.size()) malformed();
+
+    for (unsigned int i = 0; i < n_rows_; ++i) {
+        if (u32(row_offsets_ + i * 4) >= u32(row_offsets_ + (i + 1) * 4)) malformed();
+    }
+    if (rows_ + u32(row_offsets_ + n_rows_ * 4) != data_.size()) malformed();
+}
+
+LVResultStore::~LVResultStore() = default;
+
+std::vector<unsigned int> LVResultStore::entry(PP pp) const {
+    if (pp < 1 || pp > n_pps()) throw std::runtime_error("Invalid mapping index!");
+    return row(2 * (pp - 1));
+}
+
+std::vector<unsigned int> LVResultStore::exit(PP pp) const {
+    if (pp < 1 || pp > n_pps()) throw std::runtime_error("Invalid mapping index!");
+    return row(2 * (pp - 1) + 1);
+}
+
+bool LVResultStore::live_at_entry(PP pp, std::string_view var) const {
+    if (pp < 1 || pp > n_pps()) throw std::runtime_error("Invalid mapping index!");
+    return contains(2 * (pp - 1), var);
+}
+
+bool LVResultStore::live_at_exit(PP pp, std::string_view var) const {
+    if (pp < 1 || pp > n_pps()) throw std::runtime_error("Invalid mapping index!");
+    return contains(2 * (pp - 1) + 1, var);
+}
+
+LiveVariablesVec LVResultStore::materialize() const {
+    LiveVariablesVec vec(n_rows_);
+
+    for (unsigned int i = 0; i < n_rows_; ++i) {
+        // Indices ascend in the order of the set, every insert goes to the end
+        for (const auto index: row(i)) vec[i].insert(vec[i].end(), &vars_[index]);
+    }
+
+    return vec;
+}
+
+std::vector<unsigned int> LVResultStore::row(unsigned int i) const {
+    std::vector<unsigned int> indices{};
+    scan(i, [&indices](unsigned int index) {
+        indices.push_back(index);
+        return true;
+    });
+    return indices;
+}
+
+bool LVResultStore::contains(unsigned int i, std::string_view var) const {
+    const auto it = std::lower_bound(variables_.begin(), variables_.end(), var);
+    if (it == variables_.end() || *it != var) return false;
+
+    const auto index = static_cast<unsigned int>(it - variables_.begin());
+    bool found = false;
+    scan(i, [index, &found](unsigned int other) {
+        found = other == index;
+        return other < index;
+    }, index);
+    return found;
+}
+
+template<typename Visit>
+void LVResultStore::scan(unsigned int i, Visit visit, unsigned int from) const {
+    std::size_t pos = rows_ + u32(row_offsets_ + i * 4);
+    std::size_t end = rows_ + u32(row_offsets_ + (i + 1) * 4);
+
+    const auto varint = [this, &pos, &end]() {
+        std::uint64_t value = 0;
+        for (unsigned int shift = 0; shift < 64; shift += 7) {
+            if (pos == end) malformed();
+
+            const auto byte = static_cast<std::uint8_t>(data_[pos++]);
+            value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return value;
+        }
+        malformed();
+    };
+
+    auto tag = static_cast<RowTag>(data_[pos++]);
+    if (tag == RowTag::Same) {
+        // References always point to an earlier row that is stored itself
+        const auto target = varint();
+        if (target >= i) malformed();
+
+        pos = rows_ + u32(row_offsets_ + target * 4);
+        end = rows_ + u32(row_offsets_ + (target + 1) * 4);
+        tag = static_cast<RowTag>(data_[pos++]);
+    }
+
+    switch (tag) {
+        case RowTag::Bitset:
+            if (end - pos != (variables_.size() + 7) / 8) malformed();
+            for (unsigned int index = from; index < variables_.size(); ++index) {
+                if ((static_cast<std::uint8_t>(data_[pos + index / 8]) & (1 << (index % 8))) && !visit(index)) return;
+            }
+            return;
+        case RowTag::Runs: {
+            std::uint64_t next = 0;
+            for (auto n_runs = varint() / 2; n_runs > 0; --n_runs) {
+                next += varint();
+                const auto length = varint();
+                if (next + length > variables_.size()) malformed();
+
+                for (auto index = std::max<std::uint64_t>(next, from); index < next + length; ++index) {
+                    if (!visit(static_cast<unsigned int>(index))) return;
+                }
+                next += length;
+            }
+            return;
+        }
+        default:
+            malformed();
+    }
+}
+
+std::uint32_t LVResultStore::u32(std::size_t pos) const {
+    if (pos + 4 > data_.size()) malformed();
+
+    std::uint32_t value{};
+    std::memcpy(&value, data_.data() + pos, sizeof(value));
+    return value;
+}
+
+std::string LVResultStore::encode(const LiveVariablesVec& vec) {
+    std::set<std::string> names{};
+    for (const auto& set: vec) {
+        for (const auto* var: set) names.insert(var->name_);
+    }
+
+    std::unordered_map<std::string_view, unsigned int> indices{};
+    for (const auto& name: names) indices.emplace(name, indices.size());
+
+    std::string out{file_magic};
+    out.push_back(static_cast<char>(version));
+    write_u32(out, names.size());
+    write_u32(out, vec.size());
+
+    std::size_t offset = 0;
+    write_u32(out, offset);
+    for (const auto& name: names) write_u32(out, offset += name.size());
+    for (const auto& name: names) out += name;
+    out.resize((out.size() + 3) / 4 * 4, '\0');
+
+    // Every distinct row is stored once, later rows with the same variables refer to it
+    std::string rows{};
+    std::vector<std::size_t> offsets{};
+    std::unordered_map<std::string, unsigned int> stored{};
+    for (unsigned int i = 0; i < vec.size(); ++i) {
+        std::vector<unsigned int> row{};
+        for (const auto* var: vec[i]) row.push_back(indices.at(var->name_));
+
+        auto encoded = encode_row(row, names.size());
+        offsets.push_back(rows.size());
+        if (const auto it = stored.find(encoded); it != stored.end()) {
+            rows.push_back(static_cast<char>(RowTag::Same));
+            write_varint(rows, it->second);
+        } else {
+            rows += encoded;
+            stored.emplace(std::move(encoded), i);
+        }
+    }
+    offsets.push_back(rows.size());
+
+    for (const auto offset: offsets) write_u32(out, offset);
+    out += rows;
+    return out;
+}
+
+void LVResultStore::write(const LiveVariablesVec& vec, const std::filesystem::path& path) {
+    const auto data = encode(vec);
+
+    std::ofstream file{path, std::ios::binary | std::ios::trunc};
+    if (!file.is_open()) throw std::runtime_error("Error while opening file " + path.string() + "!");
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!file) throw std::runtime_error("Error while writing file " + path.string() + "!");
+}
@@ -1,7 +1,9 @@
 #include "set_utils.hpp"
 
-std::set<PP> pp_set_intersect(const std::set<PP>& set1, const std::set<PP>& set2) {
-    std::set<PP> res;
+#include "analysis_memory.hpp"
+
+ProgramPoints pp_set_intersect(const ProgramPoints& set1, const ProgramPoints& set2) {
+    ProgramPoints res{analysis_memory::resource()};
 
     std::set_intersection(
         set1.begin(), set1.end(),
@@ -16,27 +18,47 @@ std::set<PP> pp_set_intersect(const std::set<PP>& set1, const std::set<PP>& set2
  * Calculates set1 \ set2, i.e. all values in set1 that are not in set2
  */
 auto var_ptr_set_difference(
-    const std::set<const Var*, VarPtrCmp>& set1,
-    const std::set<const Var*, VarPtrCmp>& set2
-) -> std::set<const Var*, VarPtrCmp>
+    const std::pmr::set<const Var*, VarPtrCmp>& set1,
+    const std::pmr::set<const Var*, VarPtrCmp>& set2
+) -> std::pmr::set<const Var*, VarPtrCmp>
 {
-    std::set<const Var*, VarPtrCmp> res;
+    std::pmr::set<const Var*, VarPtrCmp> res{analysis_memory::resource()};
 
-    std::unordered_set<std::string> set2_names{}; // better lookup performance?
-    for (const auto v: set2) set2_names.insert(v->name_);
+    // Both sets are ordered by name, no lookup structure needed
+    std::set_difference(
+        set1.begin(), set1.end(),
+        set2.begin(), set2.end(),
+        std::inserter(res, res.end()),
+        VarPtrCmp{}
+    );
 
-    for (const Var* v: set1) {
-        if (set2_names.find(v->name_) == set2_names.end()) {
-            res.insert(v); // insert value in set1 if its not in set2
-        }
-    }
+    return res;
+}
+
+/**
+ * Calculates set1 ∩ set2 by variable name, the elements are taken from set1
+ */
+auto var_ptr_set_intersection(
+    const std::pmr::set<const Var*, VarPtrCmp>& set1,
+    const std::pmr::set<const Var*, VarPtrCmp>& set2
+) -> std::pmr::set<const Var*, VarPtrCmp>
+{
+    std::pmr::set<const Var*, VarPtrCmp> res{analysis_memory::resource()};
+
+    // Both sets are ordered by name
+    std::set_intersection(
+        set1.begin(), set1.end(),
+        set2.begin(), set2.end(),
+        std::inserter(res, res.begin()),
+        VarPtrCmp{}
+    );
 
     return res;
 }
 
 bool var_ptr_set_equality(
-    const std::set<const Var*, VarPtrCmp>& set1,
-    const std::set<const Var*, VarPtrCmp>& set2
+    const std::pmr::set<const Var*, VarPtrCmp>& set1,
+    const std::pmr::set<const Var*, VarPtrCmp>& set2
 ) {
     if (set1.size() != set2.size()) {
         return false;
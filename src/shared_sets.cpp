@@ -0,0 +1,137 @@
+#include "shared_sets.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+
+LVSet::LVSet(Node* node): node_{node} {
+    if (node_) ++node_->refs_;
+}
+
+LVSet::LVSet(const LVSet& other): LVSet{other.node_} {}
+
+LVSet::LVSet(LVSet&& other) noexcept: node_{std::exchange(other.node_, nullptr)} {}
+
+auto LVSet::operator=(const LVSet& other) -> LVSet& {
+    LVSet copy{other};
+    std::swap(node_, copy.node_);
+    return *this;
+}
+
+auto LVSet::operator=(LVSet&& other) noexcept -> LVSet& {
+    LVSet moved{std::move(other)};
+    std::swap(node_, moved.node_);
+    return *this;
+}
+
+LVSet::~LVSet() {
+    if (node_ && --node_->refs_ == 0) node_->table_->release(node_);
+}
+
+std::size_t LVSet::size() const {
+    return node_ ? node_->vars_.size() : 0;
+}
+
+const std::vector<const Var*>& LVSet::vars() const {
+    static const std::vector<const Var*> empty_vars{};
+    return node_ ? node_->vars_ : empty_vars;
+}
+
+LiveVariables LVSet::to_set() const {
+    LiveVariables set{};
+    for (const auto* var: vars()) set.insert(set.end(), var);
+    return set;
+}
+
+LVSetTable::~LVSetTable() {
+    // The memoized results hold the last handles of many sets, handles held elsewhere have to be gone by now
+    clear_memo();
+    for (auto& [hash, nodes]: unique_) {
+        for (auto* node: nodes) delete node;
+    }
+}
+
+LVSet LVSetTable::make(const LiveVariables& vars) {
+    std::vector<const Var*> canonical{};
+    canonical.reserve(vars.size());
+    for (const auto* var: vars) canonical.push_back(canonical_.try_emplace(var->name_, var).first->second);
+
+    return intern(std::move(canonical));
+}
+
+LVSet LVSetTable::unite(const LVSet& lhs, const LVSet& rhs) {
+    if (lhs == rhs || rhs.empty()) return lhs;
+    if (lhs.empty()) return rhs;
+
+    // Union commutes, one memo entry serves both orders
+    const std::pair<std::uint64_t, std::uint64_t> key = std::minmax(lhs.node_->id_, rhs.node_->id_);
+    if (const auto it = unions_.find(key); it != unions_.end()) {
+        ++memo_hits_;
+        return it->second;
+    }
+
+    std::vector<const Var*> vars{};
+    vars.reserve(lhs.size() + rhs.size());
+    std::set_union(lhs.vars().begin(), lhs.vars().end(), rhs.vars().begin(), rhs.vars().end(),
+                   std::back_inserter(vars), VarPtrCmp{});
+
+    auto result = intern(std::move(vars));
+    unions_.emplace(key, result);
+    return result;
+}
+
+LVSet LVSetTable::difference(const LVSet& lhs, const LVSet& rhs) {
+    if (lhs == rhs) return {};
+    if (lhs.empty() || rhs.empty()) return lhs;
+
+    const std::pair key{lhs.node_->id_, rhs.node_->id_};
+    if (const auto it = differences_.find(key); it != differences_.end()) {
+        ++memo_hits_;
+        return it->second;
+    }
+
+    std::vector<const Var*> vars{};
+    vars.reserve(lhs.size());
+    std::set_difference(lhs.vars().begin(), lhs.vars().end(), rhs.vars().begin(), rhs.vars().end(),
+                        std::back_inserter(vars), VarPtrCmp{});
+
+    auto result = intern(std::move(vars));
+    differences_.emplace(key, result);
+    return result;
+}
+
+void LVSetTable::clear_memo() {
+    // Releasing a result may free nodes, which only touches the unique table
+    Memo unions{}, differences{};
+    unions.swap(unions_);
+    differences.swap(differences_);
+}
+
+LVSet LVSetTable::intern(std::vector<const Var*> vars) {
+    if (vars.empty()) return {};
+
+    std::size_t hash = vars.size();
+    for (const auto* var: vars) hash = (hash ^ std::hash<const Var*>{}(var)) * 0x100000001b3ull;
+
+    auto& bucket = unique_[hash];
+    for (auto* node: bucket) {
+        if (node->vars_ == vars) return LVSet{node};
+    }
+
+    stored_elements_ += vars.size();
+    ++size_;
+    auto* node = new LVSet::Node{std::move(vars), hash, next_id_++, 0, this};
+    bucket.push_back(node);
+    return LVSet{node};
+}
+
+void LVSetTable::release(LVSet::Node* node) {
+    const auto it = unique_.find(node->hash_);
+    auto& bucket = it->second;
+    bucket.erase(std::find(bucket.begin(), bucket.end(), node));
+    if (bucket.empty()) unique_.erase(it);
+
+    stored_elements_ -= node->vars_.size();
+    --size_;
+    delete node;
+}
@@ -0,0 +1,389 @@
+#include "summary_cache.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include "c_backend.hpp"
+#include "dfa_utils.hpp"
+
+
+namespace {
+    using Entry = SummaryCache::Entry;
+
+    constexpr char file_magic[8] = {'S', 'D', 'P', 'A', 'S', 'U', 'M', '1'};
+
+    std::set<std::string> names(const FreeVariables& vars) {
+        std::set<std::string> result{};
+        for (const auto* var: vars) result.insert(result.end(), var->name_);
+        return result;
+    }
+
+    /*
+     * The statements of a sequence in program order, nested sequences are flattened.
+     */
+    std::vector<const Stmt*> elements(const Stmt* stmt) {
+        std::vector<const Stmt*> result{};
+        std::vector<const Stmt*> stack{stmt};
+
+        while (!stack.empty()) {
+            const auto* top = stack.back();
+            stack.pop_back();
+
+            if (const auto* sc = std::get_if<SeqComp>(top)) {
+                stack.push_back(sc->snd_.get());
+                stack.push_back(sc->fst_.get());
+            } else {
+                result.push_back(top);
+            }
+        }
+
+        return result;
+    }
+
+    /*
+     * The program points of stmt in program order, the order in which summaries number them.
+     */
+    std::vector<PP> program_order(const Stmt* stmt) {
+        std::vector<PP> result{};
+        std::vector<const Stmt*> stack{stmt};
+
+        while (!stack.empty()) {
+            const auto* top = stack.back();
+            stack.pop_back();
+
+            auto visitor = overload {
+                [&result](const Skip& s) {
+                    result.push_back(s.pp_);
+                },
+                [&result](const Assign& a) {
+                    result.push_back(a.pp_);
+                },
+                [&result, &stack](const If& i) {
+                    result.push_back(i.cond_->pp_);
+                    stack.push_back(i.else_.get());
+                    stack.push_back(i.then_.get());
+                },
+                [&result, &stack](const While& w) {
+                    result.push_back(w.cond_->pp_);
+                    stack.push_back(w.body_.get());
+                },
+                [&stack](const SeqComp& sc) {
+                    stack.push_back(sc.snd_.get());
+                    stack.push_back(sc.fst_.get());
+                }
+            };
+
+            std::visit(visitor, *top);
+        }
+
+        return result;
+    }
+
+    /*
+     * Appends the flow of inner to outer, with the indices of inner shifted by offset.
+     */
+    void embed(Entry& outer, const Entry& inner, unsigned int offset) {
+        for (const auto& [from, to]: inner.flow_) outer.flow_.emplace_back(from + offset, to + offset);
+    }
+
+    /*
+     * seq := seq; next
+     */
+    void append(Entry& seq, const Entry& next) {
+        if (seq.n_pps_ == 0) {
+            seq = next;
+            return;
+        }
+
+        const auto offset = seq.n_pps_;
+        for (const auto final: seq.finals_) seq.flow_.emplace_back(final, next.initial_ + offset);
+        embed(seq, next, offset);
+
+        seq.finals_.clear();
+        for (const auto final: next.finals_) seq.finals_.push_back(final + offset);
+
+        for (const auto& var: next.gen_) {
+            if (!seq.kill_.contains(var)) seq.gen_.insert(var);
+        }
+        seq.kill_.insert(next.kill_.begin(), next.kill_.end());
+        seq.n_pps_ += next.n_pps_;
+    }
+
+    /*
+     * Appends the bytes of values in host byte order.
+     */
+    template<typename T>
+    void write_value(std::string& out, T value) {
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        out.append(bytes, sizeof(T));
+    }
+
+    void write_names(std::string& out, const std::set<std::string>& names) {
+        write_value<std::uint32_t>(out, names.size());
+        for (const auto& name: names) {
+            write_value<std::uint32_t>(out, name.size());
+            out += name;
+        }
+    }
+
+    struct Reader {
+        const std::string& data_;
+        std::size_t pos_{0};
+
+        template<typename T>
+        T value() {
+            if (data_.size() - pos_ < sizeof(T)) throw std::runtime_error("Summary cache file is truncated!");
+
+            T result{};
+            std::memcpy(&result, data_.data() + pos_, sizeof(T));
+            pos_ += sizeof(T);
+            return result;
+        }
+
+        std::string name() {
+            const auto length = value<std::uint32_t>();
+            if (data_.size() - pos_ < length) throw std::runtime_error("Summary cache file is truncated!");
+
+            std::string result = data_.substr(pos_, length);
+            pos_ += length;
+            return result;
+        }
+
+        std::set<std::string> names() {
+            std::set<std::string> result{};
+            for (auto n = value<std::uint32_t>(); n > 0; --n) result.insert(result.end(), name());
+            return result;
+        }
+    };
+}
+
+SummaryCache::SummaryCache(std::filesystem::path path): path_{std::move(path)} {
+    load();
+}
+
+ProgramInfo SummaryCache::program_info(const Stmt* stmt) {
+    if (!stmt) throw std::invalid_argument("Given Stmt is empty!");
+
+    const auto hashes = ast_hash::hash_statements(stmt);
+    const auto entry = summarize(stmt, hashes);
+
+    // Maps the indices of the summary to the program points of stmt
+    const auto pps = program_order(stmt);
+    if (pps.size() != entry.n_pps_) throw std::runtime_error("Summary cache does not match the program!");
+
+    ProgramInfo info{};
+    info.pps_.insert(pps.begin(), pps.end());
+    for (const auto& [from, to]: entry.flow_) info.cf_.emplace(pps[from], pps[to]);
+    for (const auto final: entry.finals_) info.final_pps_.insert(pps[final]);
+
+    return info;
+}
+
+SummaryCache::Summaries SummaryCache::summaries(const Stmt* stmt) {
+    if (!stmt) throw std::invalid_argument("Given Stmt is empty!");
+
+    const auto hashes = ast_hash::hash_statements(stmt);
+
+    Summaries result{};
+    for (const auto& [node, hash]: hashes) {
+        if (std::holds_alternative<If>(*node) || std::holds_alternative<While>(*node)) {
+            result.emplace(node, &lookup(node, hashes));
+        }
+    }
+
+    return result;
+}
+
+const SummaryCache::Entry& SummaryCache::lookup(const Stmt* stmt, const ast_hash::StmtHashes& hashes) {
+    const auto hash = hashes.at(stmt);
+
+    {
+        const std::lock_guard lock{mutex_};
+        if (const auto it = entries_.find(hash); it != entries_.end()) {
+            ++hits_;
+            return it->second;
+        }
+    }
+
+    // Computed outside the lock, nested statements look up their own summaries.
+    // Entries are never removed and the map is node based, references stay valid.
+    Entry entry{};
+    entry.n_pps_ = 1;
+
+    auto visitor = overload {
+        [this, &hashes, &entry](const If& i) {
+            const auto then_entry = summarize(i.then_.get(), hashes);
+            const auto else_entry = summarize(i.else_.get(), hashes);
+            const auto else_offset = 1 + then_entry.n_pps_;
+
+            entry.flow_.emplace_back(0, then_entry.initial_ + 1);
+            entry.flow_.emplace_back(0, else_entry.initial_ + else_offset);
+            embed(entry, then_entry, 1);
+            embed(entry, else_entry, else_offset);
+            for (const auto final: then_entry.finals_) entry.finals_.push_back(final + 1);
+            for (const auto final: else_entry.finals_) entry.finals_.push_back(final + else_offset);
+            entry.n_pps_ += then_entry.n_pps_ + else_entry.n_pps_;
+
+            entry.gen_ = names(dfa_utils::free_variables_bexp(i.cond_->bexp_.get()));
+            entry.gen_.insert(then_entry.gen_.begin(), then_entry.gen_.end());
+            entry.gen_.insert(else_entry.gen_.begin(), else_entry.gen_.end());
+            std::set_intersection(then_entry.kill_.begin(), then_entry.kill_.end(),
+                                  else_entry.kill_.begin(), else_entry.kill_.end(),
+                                  std::inserter(entry.kill_, entry.kill_.end()));
+        },
+        [this, &hashes, &entry](const While& w) {
+            const auto body_entry = summarize(w.body_.get(), hashes);
+
+            entry.flow_.emplace_back(0, body_entry.initial_ + 1);
+            embed(entry, body_entry, 1);
+            for (const auto final: body_entry.finals_) entry.flow_.emplace_back(final + 1, 0);
+            entry.finals_.push_back(0);
+            entry.n_pps_ += body_entry.n_pps_;
+
+            entry.gen_ = names(dfa_utils::free_variables_bexp(w.cond_->bexp_.get()));
+            entry.gen_.insert(body_entry.gen_.begin(), body_entry.gen_.end());
+        },
+        [](const auto& s) {
+            throw std::invalid_argument("Only if and while statements are cached!");
+        }
+    };
+
+    std::visit(visitor, *stmt);
+
+    const std::lock_guard lock{mutex_};
+    ++misses_;
+    return entries_.emplace(hash, std::move(entry)).first->second;
+}
+
+SummaryCache::Entry SummaryCache::summarize(const Stmt* stmt, const ast_hash::StmtHashes& hashes) {
+    Entry result{};
+
+    for (const auto* element: elements(stmt)) {
+        auto visitor = overload {
+            [&result](const Skip& s) {
+                append(result, Entry{1, {}, 0, {0}, {}, {}});
+            },
+            [&result](const Assign& a) {
+                append(result, Entry{1, {}, 0, {0}, names(dfa_utils::free_variables_aexp(a.aexp_.get())),
+                                     {a.var_->name_}});
+            },
+            [this, &hashes, &result, element](const auto& s) {
+                append(result, lookup(element, hashes));
+            }
+        };
+
+        std::visit(visitor, *element);
+    }
+
+    return result;
+}
+
+void SummaryCache::save() const {
+    if (path_.empty()) return;
+
+    std::string out{file_magic, sizeof(file_magic)};
+    {
+        const std::lock_guard lock{mutex_};
+
+        write_value<std::uint64_t>(out, entries_.size());
+        for (const auto& [hash, entry]: entries_) {
+            write_value<std::uint64_t>(out, hash);
+            write_value<std::uint32_t>(out, entry.n_pps_);
+            write_value<std::uint32_t>(out, entry.initial_);
+
+            write_value<std::uint32_t>(out, entry.finals_.size());
+            for (const auto final: entry.finals_) write_value<std::uint32_t>(out, final);
+
+            write_value<std::uint32_t>(out, entry.flow_.size());
+            for (const auto& [from, to]: entry.flow_) {
+                write_value<std::uint32_t>(out, from);
+                write_value<std::uint32_t>(out, to);
+            }
+
+            write_names(out, entry.gen_);
+            write_names(out, entry.kill_);
+        }
+    }
+
+    // Write next to the target and rename, concurrent runs never see a partial file
+    if (path_.has_parent_path()) std::filesystem::create_directories(path_.parent_path());
+    auto tmp_path = path_;
+    tmp_path += ".tmp";
+
+    {
+        std::ofstream file{tmp_path, std::ios::binary | std::ios::trunc};
+        if (!file.is_open()) throw std::runtime_error("Error while writing summary cache " + tmp_path.string() + "!");
+        file.write(out.data(), static_cast<std::streamsize>(out.size()));
+        if (!file) throw std::runtime_error("Error while writing summary cache " + tmp_path.string() + "!");
+    }
+
+    std::filesystem::rename(tmp_path, path_);
+}
+
+void SummaryCache::load() {
+    std::ifstream file{path_, std::ios::binary};
+    if (!file.is_open()) return;
+
+    const std::string data{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    if (data.size() < sizeof(file_magic) || data.compare(0, sizeof(file_magic), file_magic, sizeof(file_magic)) != 0) {
+        return;
+    }
+
+    try {
+        Reader reader{data, sizeof(file_magic)};
+
+        for (auto n = reader.value<std::uint64_t>(); n > 0; --n) {
+            const auto hash = reader.value<std::uint64_t>();
+
+            Entry entry{};
+            entry.n_pps_ = reader.value<std::uint32_t>();
+            entry.initial_ = reader.value<std::uint32_t>();
+
+            for (auto n_finals = reader.value<std::uint32_t>(); n_finals > 0; --n_finals) {
+                entry.finals_.push_back(reader.value<std::uint32_t>());
+            }
+            for (auto n_flow = reader.value<std::uint32_t>(); n_flow > 0; --n_flow) {
+                const auto from = reader.value<std::uint32_t>();
+                entry.flow_.emplace_back(from, reader.value<std::uint32_t>());
+            }
+
+            entry.gen_ = reader.names();
+            entry.kill_ = reader.names();
+
+            const auto in_range = [&entry](unsigned int i) { return i < entry.n_pps_; };
+            const bool valid = in_range(entry.initial_) && std::all_of(entry.finals_.begin(), entry.finals_.end(), in_range)
+                && std::all_of(entry.flow_.begin(), entry.flow_.end(),
+                               [&in_range](const auto& edge) { return in_range(edge.first) && in_range(edge.second); });
+            if (!valid) throw std::runtime_error("Summary cache file is corrupt!");
+
+            entries_.emplace(hash, std::move(entry));
+        }
+    } catch (const std::runtime_error&) {
+        // A cache is only an optimization, start over instead of failing the analysis
+        entries_.clear();
+    }
+}
+
+std::size_t SummaryCache::size() const {
+    const std::lock_guard lock{mutex_};
+    return entries_.size();
+}
+
+std::size_t SummaryCache::hits() const {
+    const std::lock_guard lock{mutex_};
+    return hits_;
+}
+
+std::size_t SummaryCache::misses() const {
+    const std::lock_guard lock{mutex_};
+    return misses_;
+}
+
+std::filesystem::path SummaryCache::default_path() {
+    return CProgram::default_cache_dir() / "summaries.bin";
+}
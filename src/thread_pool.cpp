@@ -0,0 +1,132 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+
+
+namespace {
+    // Index of the pool worker running on this thread, or -1 outside of any pool
+    thread_local int current_worker = -1;
+    thread_local const void* current_pool = nullptr;
+}
+
+
+ThreadPool::ThreadPool(unsigned int n_threads):
+    next_queue_{0}, queued_{0}, pending_{0}, stop_{false}
+{
+    if (n_threads == 0) n_threads = 1;
+
+    for (unsigned int i = 0; i < n_threads; ++i) {
+        queues_.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (unsigned int i = 0; i < n_threads; ++i) {
+        threads_.emplace_back(&ThreadPool::worker_loop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock{mutex_};
+        stop_ = true;
+    }
+    work_cv_.notify_all();
+
+    for (auto& thread: threads_) thread.join();
+}
+
+void ThreadPool::submit(Task task) {
+    const unsigned int idx = (current_pool == this)
+        ? static_cast<unsigned int>(current_worker)
+        : next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+
+    // Count the task before it becomes visible, so no worker can finish it before it was counted
+    {
+        std::lock_guard lock{mutex_};
+        ++queued_;
+        ++pending_;
+    }
+    {
+        std::lock_guard lock{queues_[idx]->mutex_};
+        queues_[idx]->tasks_.push_back(std::move(task));
+    }
+    work_cv_.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock lock{mutex_};
+    done_cv_.wait(lock, [this]() { return pending_ == 0; });
+
+    if (error_) {
+        auto error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::parallel_for(std::size_t n, std::size_t grain, const std::function<void(std::size_t, std::size_t)>& body) {
+    if (grain == 0) grain = 1;
+
+    for (std::size_t begin = 0; begin < n; begin += grain) {
+        const std::size_t end = std::min(begin + grain, n);
+        submit([&body, begin, end]() { body(begin, end); });
+    }
+    wait();
+}
+
+void ThreadPool::worker_loop(unsigned int idx) {
+    current_worker = static_cast<int>(idx);
+    current_pool = this;
+
+    while (true) {
+        {
+            std::unique_lock lock{mutex_};
+            work_cv_.wait(lock, [this]() { return stop_ || queued_ > 0; });
+            if (stop_ && queued_ == 0) return;
+        }
+
+        Task task{};
+        if (!try_pop(idx, task) && !try_steal(idx, task)) continue;
+
+        {
+            std::lock_guard lock{mutex_};
+            --queued_;
+        }
+
+        try {
+            task();
+        } catch (...) {
+            std::lock_guard lock{mutex_};
+            if (!error_) error_ = std::current_exception();
+        }
+
+        {
+            std::lock_guard lock{mutex_};
+            if (--pending_ == 0) done_cv_.notify_all();
+        }
+    }
+}
+
+bool ThreadPool::try_pop(unsigned int idx, Task& task) {
+    auto& queue = *queues_[idx];
+    std::lock_guard lock{queue.mutex_};
+
+    if (queue.tasks_.empty()) return false;
+
+    task = std::move(queue.tasks_.back());
+    queue.tasks_.pop_back();
+    return true;
+}
+
+bool ThreadPool::try_steal(unsigned int idx, Task& task) {
+    for (unsigned int offset = 1; offset < queues_.size(); ++offset) {
+        auto& queue = *queues_[(idx + offset) % queues_.size()];
+        std::lock_guard lock{queue.mutex_};
+
+        if (queue.tasks_.empty()) continue;
+
+        task = std::move(queue.tasks_.front());
+        queue.tasks_.pop_front();
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,198 @@
+#include "var_sets.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+
+VarIndex::VarIndex(const FreeVariables& vars) {
+    vars_.reserve(vars.size());
+    for (const auto* var: vars) {
+        indices_.emplace(var->name_, static_cast<unsigned int>(vars_.size()));
+        vars_.push_back(var);
+    }
+}
+
+unsigned int VarIndex::index(const Var* var) const {
+    const auto it = indices_.find(var->name_);
+    if (it == indices_.end()) throw std::runtime_error("Unknown variable " + var->name_ + "!");
+    return it->second;
+}
+
+void SparseVarSet::insert(unsigned int i) {
+    const auto key = static_cast<std::uint16_t>(i >> 16);
+    const auto low = static_cast<std::uint16_t>(i);
+
+    auto it = std::lower_bound(chunks_.begin(), chunks_.end(), key,
+                               [](const Chunk& chunk, std::uint16_t k) { return chunk.key_ < k; });
+    if (it == chunks_.end() || it->key_ != key) it = chunks_.insert(it, Chunk{key, 0, {}, {}});
+
+    if (it->bitmap_.empty()) {
+        const auto pos = std::lower_bound(it->array_.begin(), it->array_.end(), low);
+        if (pos != it->array_.end() && *pos == low) return;
+        it->array_.insert(pos, low);
+    } else {
+        auto& word = it->bitmap_[low / 64];
+        const auto bit = std::uint64_t{1} << (low % 64);
+        if (word & bit) return;
+        word |= bit;
+    }
+    ++it->size_;
+    normalize(*it);
+}
+
+bool SparseVarSet::contains(unsigned int i) const {
+    const auto key = static_cast<std::uint16_t>(i >> 16);
+    const auto low = static_cast<std::uint16_t>(i);
+
+    const auto it = std::lower_bound(chunks_.begin(), chunks_.end(), key,
+                                     [](const Chunk& chunk, std::uint16_t k) { return chunk.key_ < k; });
+    if (it == chunks_.end() || it->key_ != key) return false;
+
+    if (it->bitmap_.empty()) return std::binary_search(it->array_.begin(), it->array_.end(), low);
+    return it->bitmap_[low / 64] >> (low % 64) & 1;
+}
+
+void SparseVarSet::unite(const SparseVarSet& other) {
+    if (other.chunks_.empty()) return;
+    if (chunks_.empty()) {
+        chunks_ = other.chunks_;
+        return;
+    }
+
+    // Usually every chunk of other is already there and the chunks are united in place
+    auto lhs = chunks_.begin();
+    for (const auto& chunk: other.chunks_) {
+        while (lhs != chunks_.end() && lhs->key_ < chunk.key_) ++lhs;
+        if (lhs == chunks_.end() || lhs->key_ != chunk.key_) return merge(other);
+    }
+
+    lhs = chunks_.begin();
+    for (const auto& chunk: other.chunks_) {
+        while (lhs->key_ < chunk.key_) ++lhs;
+        unite(*lhs, chunk);
+    }
+}
+
+void SparseVarSet::subtract(const SparseVarSet& other) {
+    if (chunks_.empty() || other.chunks_.empty()) return;
+
+    auto rhs = other.chunks_.begin();
+    for (auto& chunk: chunks_) {
+        while (rhs != other.chunks_.end() && rhs->key_ < chunk.key_) ++rhs;
+        if (rhs == other.chunks_.end()) break;
+        if (rhs->key_ == chunk.key_) subtract(chunk, *rhs);
+    }
+
+    std::erase_if(chunks_, [](const Chunk& chunk) { return chunk.size_ == 0; });
+}
+
+void SparseVarSet::merge(const SparseVarSet& other) {
+    std::vector<Chunk> merged{};
+    merged.reserve(chunks_.size() + other.chunks_.size());
+    auto lhs = chunks_.begin();
+    auto rhs = other.chunks_.begin();
+    while (lhs != chunks_.end() || rhs != other.chunks_.end()) {
+        if (rhs == other.chunks_.end() || (lhs != chunks_.end() && lhs->key_ < rhs->key_)) {
+            merged.push_back(std::move(*lhs++));
+        } else if (lhs == chunks_.end() || rhs->key_ < lhs->key_) {
+            merged.push_back(*rhs++);
+        } else {
+            unite(*lhs, *rhs++);
+            merged.push_back(std::move(*lhs++));
+        }
+    }
+    chunks_ = std::move(merged);
+}
+
+std::size_t SparseVarSet::size() const {
+    std::size_t n = 0;
+    for (const auto& chunk: chunks_) n += chunk.size_;
+    return n;
+}
+
+std::size_t SparseVarSet::bytes() const {
+    std::size_t n = chunks_.size() * sizeof(Chunk);
+    for (const auto& chunk: chunks_) {
+        n += chunk.array_.size() * sizeof(std::uint16_t) + chunk.bitmap_.size() * sizeof(std::uint64_t);
+    }
+    return n;
+}
+
+void SparseVarSet::unite(Chunk& chunk, const Chunk& other) {
+    if (!chunk.bitmap_.empty() || !other.bitmap_.empty()) {
+        // At least one side is dense, so is the result
+        if (chunk.bitmap_.empty()) {
+            chunk.bitmap_.assign(bitmap_words, 0);
+            for (const auto low: chunk.array_) chunk.bitmap_[low / 64] |= std::uint64_t{1} << (low % 64);
+            chunk.array_ = {};
+        }
+        if (other.bitmap_.empty()) {
+            for (const auto low: other.array_) chunk.bitmap_[low / 64] |= std::uint64_t{1} << (low % 64);
+        } else {
+            for (std::size_t w = 0; w < bitmap_words; ++w) chunk.bitmap_[w] |= other.bitmap_[w];
+        }
+
+        chunk.size_ = 0;
+        for (const auto word: chunk.bitmap_) chunk.size_ += std::popcount(word);
+        return;
+    }
+
+    if (std::includes(chunk.array_.begin(), chunk.array_.end(), other.array_.begin(), other.array_.end())) return;
+
+    // Merged into a scratch buffer, assigning it back keeps the storage of the chunk
+    thread_local std::vector<std::uint16_t> array{};
+    array.clear();
+    std::set_union(chunk.array_.begin(), chunk.array_.end(), other.array_.begin(), other.array_.end(),
+                   std::back_inserter(array));
+    chunk.array_.assign(array.begin(), array.end());
+    chunk.size_ = static_cast<std::uint32_t>(chunk.array_.size());
+    normalize(chunk);
+}
+
+void SparseVarSet::subtract(Chunk& chunk, const Chunk& other) {
+    if (chunk.bitmap_.empty()) {
+        if (other.bitmap_.empty()) {
+            // In place, the kept elements never overtake the one being read
+            auto out = chunk.array_.begin();
+            auto rhs = other.array_.begin();
+            for (const auto low: chunk.array_) {
+                while (rhs != other.array_.end() && *rhs < low) ++rhs;
+                if (rhs == other.array_.end() || *rhs != low) *out++ = low;
+            }
+            chunk.array_.erase(out, chunk.array_.end());
+        } else {
+            std::erase_if(chunk.array_, [&other](std::uint16_t low) { return other.bitmap_[low / 64] >> (low % 64) & 1; });
+        }
+        chunk.size_ = static_cast<std::uint32_t>(chunk.array_.size());
+        return;
+    }
+
+    if (other.bitmap_.empty()) {
+        for (const auto low: other.array_) chunk.bitmap_[low / 64] &= ~(std::uint64_t{1} << (low % 64));
+    } else {
+        for (std::size_t w = 0; w < bitmap_words; ++w) chunk.bitmap_[w] &= ~other.bitmap_[w];
+    }
+
+    chunk.size_ = 0;
+    for (const auto word: chunk.bitmap_) chunk.size_ += std::popcount(word);
+    normalize(chunk);
+}
+
+void SparseVarSet::normalize(Chunk& chunk) {
+    if (chunk.bitmap_.empty() && chunk.size_ > max_array) {
+        chunk.bitmap_.assign(bitmap_words, 0);
+        for (const auto low: chunk.array_) chunk.bitmap_[low / 64] |= std::uint64_t{1} << (low % 64);
+        chunk.array_ = {};
+    } else if (!chunk.bitmap_.empty() && chunk.size_ <= max_array) {
+        std::vector<std::uint16_t> array{};
+        array.reserve(chunk.size_);
+        for (std::size_t w = 0; w < bitmap_words; ++w) {
+            for (auto word = chunk.bitmap_[w]; word; word &= word - 1) {
+                array.push_back(static_cast<std::uint16_t>(w * 64 + std::countr_zero(word)));
+            }
+        }
+        chunk.array_ = std::move(array);
+        chunk.bitmap_ = {};
+    }
+}